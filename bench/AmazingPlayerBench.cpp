@@ -0,0 +1,221 @@
+// 无窗口、无音频设备的解码流水线基准。
+// 复用 MediaSession（经 PlayerRender）的 LoadMedia / 解复用 / 解码线程 / processVideoFrame，尽可能快地消费解码帧，
+// 以 JSON 输出各阶段吞吐与 p50/p99 延迟，可在无显示器、无声卡的 CI 机器上运行。
+//
+// 用法:
+//   AmazingPlayerBench [options] <file>
+//   AmazingPlayerBench --generate clip.mkv [--seconds 5] [--size 1280x720] [--fps 30] [--no-audio]
+//
+// 只给出 --generate 时先生成片段再对其做基准。
+// --max-first-frame-ms 作为启动耗时的回归检查：首帧晚于该值时返回非零（CI 在生成的片段上运行）。
+
+#include "Render/PlayerRender.h"
+#include "ClipGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+void printUsage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [options] [file]\n"
+              << "  --generate PATH     generate a test clip with the ffmpeg encoders first\n"
+              << "  --seconds N         generated clip length (default 5)\n"
+              << "  --size WxH          generated clip size (default 640x360)\n"
+              << "  --fps N             generated clip frame rate (default 30)\n"
+              << "  --codec NAME        generated clip codec: auto | h264 | mpeg4\n"
+              << "  --no-audio          generate without an audio stream\n"
+              << "  --threads N         video decoder threads (0 = auto)\n"
+              << "  --no-fast-start     full stream probing before playback\n"
+              << "  --max-first-frame-ms N  fail if the first frame takes longer than N ms\n"
+              << "  --input MODE        default | mmap | readahead (default readahead)\n"
+              << "  --read-ahead MB     read-ahead window size in MB (default 32)\n"
+              << "  --json PATH         write the JSON report to PATH instead of stdout\n"
+              << "  --metrics PATH      append periodic metrics snapshots (JSON lines) to PATH\n"
+              << "  --trace PATH        write a Chrome trace JSON of the run to PATH\n";
+}
+
+void writeStage(std::ostream& os, const char* name, const StageSamples& s, bool last = false)
+{
+    double totalSec = s.TotalMicros() / 1e6;
+    os << "    \"" << name << "\": {"
+       << "\"count\": " << s.count
+       << ", \"bytes\": " << s.bytes
+       << ", \"busy_ms\": " << totalSec * 1e3
+       << ", \"ops_per_s\": " << (totalSec > 0 ? s.count / totalSec : 0.0)
+       << ", \"mb_per_s\": " << (totalSec > 0 ? s.bytes / totalSec / 1e6 : 0.0)
+       << ", \"p50_us\": " << s.Percentile(0.50)
+       << ", \"p99_us\": " << s.Percentile(0.99)
+       << "}" << (last ? "\n" : ",\n");
+}
+
+std::string jsonEscape(const std::string& in)
+{
+    std::string out;
+    for (char c : in) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    ClipSpec clip;
+    std::string generatePath, file, jsonPath;
+    double maxFirstFrameMs = 0.0;
+    PlayerOptions options;
+    options.headless = true;
+    options.collectTimings = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--generate" && hasValue) {
+            generatePath = argv[++i];
+        } else if (arg == "--seconds" && hasValue) {
+            clip.seconds = std::atof(argv[++i]);
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &clip.width, &clip.height) != 2) {
+                std::cerr << "Invalid size: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--fps" && hasValue) {
+            clip.fps = std::atoi(argv[++i]);
+        } else if (arg == "--codec" && hasValue) {
+            clip.videoCodec = argv[++i];
+        } else if (arg == "--no-audio") {
+            clip.audio = false;
+        } else if (arg == "--threads" && hasValue) {
+            options.decodeThreads = std::atoi(argv[++i]);
+        } else if (arg == "--no-fast-start") {
+            options.fastStart = false;
+        } else if (arg == "--max-first-frame-ms" && hasValue) {
+            maxFirstFrameMs = std::atof(argv[++i]);
+        } else if (arg == "--input" && hasValue) {
+            if (!ParseInputMode(argv[++i], options.inputMode)) {
+                std::cerr << "Unknown input mode: " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--read-ahead" && hasValue) {
+            options.readAheadBytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) * 1024 * 1024;
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--metrics" && hasValue) {
+            options.metricsFile = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            options.traceFile = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            file = arg;
+        }
+    }
+
+    if (!generatePath.empty()) {
+        if (!GenerateTestClip(generatePath, clip)) {
+            std::cerr << "Failed to generate test clip\n";
+            return 1;
+        }
+        if (file.empty()) file = generatePath;
+    }
+
+    if (file.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    PlayerRender player(options);
+    player.OpenMediaAsync(file);
+    if (!player.Initialize() || !player.LoadMedia(file)) {
+        std::cerr << "Failed to load " << file << "\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    player.Play();
+    player.RunHeadless();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const PipelineTimings& t = player.Timings();
+    uint64_t frames = t.queueWait.count;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\n"
+         << "  \"file\": \"" << jsonEscape(file) << "\",\n"
+         << "  \"width\": " << player.VideoWidth() << ",\n"
+         << "  \"height\": " << player.VideoHeight() << ",\n"
+         << "  \"wall_seconds\": " << wall << ",\n"
+         << "  \"frames\": " << frames << ",\n"
+         << "  \"fps\": " << (wall > 0 ? frames / wall : 0.0) << ",\n";
+
+    const StartupTimings& st = player.Startup();
+    json << "  \"startup\": {"
+         << "\"fast_start\": " << (options.fastStart ? "true" : "false")
+         << ", \"stream_info_skipped\": " << (st.streamInfoSkipped ? "true" : "false")
+         << ", \"input_opened_ms\": " << st.inputOpenedMs
+         << ", \"stream_info_ms\": " << st.streamInfoMs
+         << ", \"media_loaded_ms\": " << st.mediaLoadedMs
+         << ", \"first_frame_decoded_ms\": " << st.firstFrameQueuedMs
+         << ", \"first_frame_ms\": " << st.firstFrameShownMs
+         << "},\n";
+
+    // 解复用 I/O 单独报告：读取回调的等待时间和后台预读吞吐
+    InputStats io = player.IoStats();
+    json << "  \"input\": {"
+         << "\"mode\": \"" << InputModeName(player.ActiveInputMode()) << "\""
+         << ", \"reads\": " << io.reads
+         << ", \"bytes\": " << io.bytes
+         << ", \"read_ms\": " << io.readMicros / 1e3
+         << ", \"max_read_us\": " << io.maxReadMicros
+         << ", \"stalls\": " << io.stalls
+         << ", \"stall_ms\": " << io.stallMicros / 1e3
+         << ", \"seeks\": " << io.seeks
+         << ", \"window_seeks\": " << io.windowSeeks
+         << ", \"fetch_mb_per_s\": " << (io.fetchMicros > 0 ? io.fetchBytes / io.fetchMicros : 0.0)
+         << "},\n"
+         << "  \"stages\": {\n";
+    writeStage(json, "input", t.input);
+    writeStage(json, "demux", t.demux);
+    writeStage(json, "video_decode", t.videoDecode);
+    writeStage(json, "audio_decode", t.audioDecode);
+    writeStage(json, "convert", t.convert);
+    writeStage(json, "queue", t.queueWait, true);
+    json << "  }\n}\n";
+
+    if (jsonPath.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Failed to write " << jsonPath << "\n";
+            return 1;
+        }
+        out << json.str();
+        std::cout << "Report written to " << jsonPath << "\n";
+    }
+
+    if (maxFirstFrameMs > 0.0 && (frames == 0 || st.firstFrameShownMs > maxFirstFrameMs)) {
+        std::cerr << "First frame after " << st.firstFrameShownMs << " ms exceeds the "
+                  << maxFirstFrameMs << " ms budget\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,241 @@
+#include "ClipGenerator.h"
+#include <iostream>
+#include <cmath>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#include <libavutil/channel_layout.h>
+}
+
+namespace {
+
+struct OutputStream {
+    AVCodecContext* enc = nullptr;
+    AVStream* st = nullptr;
+    AVFrame* frame = nullptr;
+    int64_t nextPts = 0;
+
+    double NextSeconds() const { return nextPts * av_q2d(enc->time_base); }
+
+    void Free()
+    {
+        av_frame_free(&frame);
+        avcodec_free_context(&enc);
+    }
+};
+
+bool encodeAndWrite(OutputStream& os, AVFrame* frame, AVFormatContext* oc, AVPacket* pkt)
+{
+    int ret = avcodec_send_frame(os.enc, frame);
+    if (ret < 0) {
+        std::cerr << "Failed to send frame to encoder\n";
+        return false;
+    }
+    while ((ret = avcodec_receive_packet(os.enc, pkt)) >= 0) {
+        av_packet_rescale_ts(pkt, os.enc->time_base, os.st->time_base);
+        pkt->stream_index = os.st->index;
+        if (av_interleaved_write_frame(oc, pkt) < 0) {
+            std::cerr << "Failed to write packet\n";
+            return false;
+        }
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+}
+
+const AVCodec* findVideoEncoder(const std::string& name)
+{
+    if (name == "mpeg4") return avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+    const AVCodec* h264 = avcodec_find_encoder(AV_CODEC_ID_H264);
+    if (name == "h264" || h264) return h264;
+    return avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+}
+
+bool openVideoStream(OutputStream& os, AVFormatContext* oc, const ClipSpec& spec)
+{
+    const AVCodec* codec = findVideoEncoder(spec.videoCodec);
+    if (!codec) {
+        std::cerr << "No video encoder available for " << spec.videoCodec << "\n";
+        return false;
+    }
+
+    os.enc = avcodec_alloc_context3(codec);
+    if (!os.enc) return false;
+    os.enc->width = spec.width;
+    os.enc->height = spec.height;
+    os.enc->time_base = AVRational{1, spec.fps};
+    os.enc->framerate = AVRational{spec.fps, 1};
+    os.enc->pix_fmt = AV_PIX_FMT_YUV420P;
+    os.enc->gop_size = spec.fps;      // 每秒一个关键帧，方便测试 seek / 缩略图
+    os.enc->max_b_frames = 2;
+    os.enc->bit_rate = static_cast<int64_t>(spec.width) * spec.height * spec.fps / 8;
+    if (oc->oformat->flags & AVFMT_GLOBALHEADER) {
+        os.enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    if (avcodec_open2(os.enc, codec, nullptr) < 0) {
+        std::cerr << "Failed to open video encoder " << codec->name << "\n";
+        return false;
+    }
+
+    os.st = avformat_new_stream(oc, nullptr);
+    if (!os.st || avcodec_parameters_from_context(os.st->codecpar, os.enc) < 0) return false;
+    os.st->time_base = os.enc->time_base;
+
+    os.frame = av_frame_alloc();
+    if (!os.frame) return false;
+    os.frame->format = os.enc->pix_fmt;
+    os.frame->width = os.enc->width;
+    os.frame->height = os.enc->height;
+    if (av_frame_get_buffer(os.frame, 0) < 0) return false;
+
+    std::cout << "Video encoder: " << codec->name << " " << spec.width << "x" << spec.height
+              << " @ " << spec.fps << " fps\n";
+    return true;
+}
+
+bool openAudioStream(OutputStream& os, AVFormatContext* oc)
+{
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+    if (!codec) codec = avcodec_find_encoder(AV_CODEC_ID_PCM_S16LE);
+    if (!codec) {
+        std::cerr << "No audio encoder available\n";
+        return false;
+    }
+
+    os.enc = avcodec_alloc_context3(codec);
+    if (!os.enc) return false;
+    os.enc->sample_fmt = codec->sample_fmts ? codec->sample_fmts[0] : AV_SAMPLE_FMT_S16;
+    if (os.enc->sample_fmt != AV_SAMPLE_FMT_FLTP && os.enc->sample_fmt != AV_SAMPLE_FMT_S16) {
+        std::cerr << "Unsupported audio encoder sample format\n";
+        return false;
+    }
+    os.enc->sample_rate = 48000;
+    av_channel_layout_default(&os.enc->ch_layout, 2);
+    os.enc->bit_rate = 128000;
+    os.enc->time_base = AVRational{1, os.enc->sample_rate};
+    if (oc->oformat->flags & AVFMT_GLOBALHEADER) {
+        os.enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    if (avcodec_open2(os.enc, codec, nullptr) < 0) {
+        std::cerr << "Failed to open audio encoder " << codec->name << "\n";
+        return false;
+    }
+
+    os.st = avformat_new_stream(oc, nullptr);
+    if (!os.st || avcodec_parameters_from_context(os.st->codecpar, os.enc) < 0) return false;
+    os.st->time_base = os.enc->time_base;
+
+    os.frame = av_frame_alloc();
+    if (!os.frame) return false;
+    os.frame->format = os.enc->sample_fmt;
+    os.frame->nb_samples = os.enc->frame_size > 0 ? os.enc->frame_size : 1024;
+    os.frame->sample_rate = os.enc->sample_rate;
+    av_channel_layout_copy(&os.frame->ch_layout, &os.enc->ch_layout);
+    if (av_frame_get_buffer(os.frame, 0) < 0) return false;
+    return true;
+}
+
+// 移动的渐变背景 + 白色方块，保证每帧内容不同
+void fillVideoFrame(AVFrame* f, int64_t index)
+{
+    int t = static_cast<int>(index);
+    int boxX = (t * 8) % (f->width > 64 ? f->width - 64 : 1);
+    int boxY = (t * 4) % (f->height > 64 ? f->height - 64 : 1);
+    for (int y = 0; y < f->height; ++y) {
+        uint8_t* row = f->data[0] + y * f->linesize[0];
+        for (int x = 0; x < f->width; ++x) {
+            bool inBox = x >= boxX && x < boxX + 64 && y >= boxY && y < boxY + 64;
+            row[x] = inBox ? 235 : static_cast<uint8_t>(x + y + t * 3);
+        }
+    }
+    for (int y = 0; y < f->height / 2; ++y) {
+        uint8_t* u = f->data[1] + y * f->linesize[1];
+        uint8_t* v = f->data[2] + y * f->linesize[2];
+        for (int x = 0; x < f->width / 2; ++x) {
+            u[x] = static_cast<uint8_t>(128 + y + t * 2);
+            v[x] = static_cast<uint8_t>(64 + x + t * 5);
+        }
+    }
+}
+
+void fillAudioFrame(AVFrame* f, int64_t firstSample)
+{
+    const double pi = 3.14159265358979323846;
+    const double step = 2.0 * pi * 440.0 / f->sample_rate;
+    int channels = f->ch_layout.nb_channels;
+    for (int i = 0; i < f->nb_samples; ++i) {
+        double v = 0.25 * std::sin(step * (firstSample + i));
+        for (int c = 0; c < channels; ++c) {
+            if (f->format == AV_SAMPLE_FMT_FLTP) {
+                reinterpret_cast<float*>(f->data[c])[i] = static_cast<float>(v);
+            } else {
+                reinterpret_cast<int16_t*>(f->data[0])[i * channels + c] = static_cast<int16_t>(v * 32767);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool GenerateTestClip(const std::string& path, const ClipSpec& spec)
+{
+    AVFormatContext* oc = nullptr;
+    if (avformat_alloc_output_context2(&oc, nullptr, nullptr, path.c_str()) < 0 || !oc) {
+        std::cerr << "Failed to create output context for " << path << "\n";
+        return false;
+    }
+
+    OutputStream video, audio;
+    AVPacket* pkt = av_packet_alloc();
+    bool ok = pkt && openVideoStream(video, oc, spec);
+    bool hasAudio = ok && spec.audio && openAudioStream(audio, oc);
+
+    if (ok && !(oc->oformat->flags & AVFMT_NOFILE)) {
+        ok = avio_open(&oc->pb, path.c_str(), AVIO_FLAG_WRITE) >= 0;
+        if (!ok) std::cerr << "Failed to open output file " << path << "\n";
+    }
+    if (ok) ok = avformat_write_header(oc, nullptr) >= 0;
+
+    const int64_t totalFrames = static_cast<int64_t>(spec.seconds * spec.fps);
+    const int64_t totalSamples = static_cast<int64_t>(spec.seconds * 48000);
+
+    // 按时间交错写入音视频
+    while (ok) {
+        bool videoDone = video.nextPts >= totalFrames;
+        bool audioDone = !hasAudio || audio.nextPts >= totalSamples;
+        if (videoDone && audioDone) break;
+
+        if (!videoDone && (audioDone || video.NextSeconds() <= audio.NextSeconds())) {
+            if (av_frame_make_writable(video.frame) < 0) { ok = false; break; }
+            fillVideoFrame(video.frame, video.nextPts);
+            video.frame->pts = video.nextPts++;
+            ok = encodeAndWrite(video, video.frame, oc, pkt);
+        } else {
+            if (av_frame_make_writable(audio.frame) < 0) { ok = false; break; }
+            fillAudioFrame(audio.frame, audio.nextPts);
+            audio.frame->pts = audio.nextPts;
+            audio.nextPts += audio.frame->nb_samples;
+            ok = encodeAndWrite(audio, audio.frame, oc, pkt);
+        }
+    }
+
+    // 冲刷编码器
+    if (ok) ok = encodeAndWrite(video, nullptr, oc, pkt);
+    if (ok && hasAudio) ok = encodeAndWrite(audio, nullptr, oc, pkt);
+    if (ok) ok = av_write_trailer(oc) >= 0;
+
+    video.Free();
+    audio.Free();
+    av_packet_free(&pkt);
+    if (oc->pb && !(oc->oformat->flags & AVFMT_NOFILE)) avio_closep(&oc->pb);
+    avformat_free_context(oc);
+
+    if (ok) {
+        std::cout << "Generated " << path << " (" << spec.seconds << "s"
+                  << (hasAudio ? ", with audio" : "") << ")\n";
+    }
+    return ok;
+}
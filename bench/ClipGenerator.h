@@ -0,0 +1,19 @@
+#ifndef CLIPGENERATOR_H
+#define CLIPGENERATOR_H
+
+#include <string>
+
+// 用 FFmpeg 自带编码器生成小测试片段，便于在无素材的 CI 机器上跑基准
+struct ClipSpec {
+    int width = 640;
+    int height = 360;
+    int fps = 30;
+    double seconds = 5.0;
+    bool audio = true;                // 48kHz 立体声正弦波
+    std::string videoCodec = "auto";  // auto（优先 H.264，否则 MPEG-4）| h264 | mpeg4
+};
+
+// 按扩展名选择容器（推荐 .mkv / .mp4），成功返回 true
+bool GenerateTestClip(const std::string& path, const ClipSpec& spec);
+
+#endif
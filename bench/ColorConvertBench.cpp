@@ -0,0 +1,204 @@
+// ColorConvert 的校验与微基准。
+// 先在多种尺寸（含 SIMD 块宽之外的尾部像素）、色彩空间和范围下，逐位比较每个可用指令集与标量实现；
+// 再在同一组帧上对比各指令集与 sws_scale（YUV420P/NV12 → RGBA，同尺寸）的吞吐。
+//
+// 用法: ColorConvertBench [WxH] [frames]
+
+#include "Render/ColorConvert.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+constexpr ConvertIsa ALL_ISAS[] = { ConvertIsa::Scalar, ConvertIsa::Sse41, ConvertIsa::Avx2, ConvertIsa::Neon };
+
+// 一帧 YUV420P 或 NV12 测试图像，行尾留有填充以覆盖 stride != width 的情况
+struct TestFrame {
+    AVPixelFormat format = AV_PIX_FMT_YUV420P;
+    int width = 0, height = 0;
+    std::vector<uint8_t> planes[3];
+    const uint8_t* data[3] = {nullptr, nullptr, nullptr};
+    int linesize[3] = {0, 0, 0};
+};
+
+TestFrame makeFrame(AVPixelFormat format, int w, int h, uint32_t seed)
+{
+    TestFrame f;
+    f.format = format;
+    f.width = w;
+    f.height = h;
+
+    int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    f.linesize[0] = w + 24;
+    if (format == AV_PIX_FMT_NV12) {
+        f.linesize[1] = cw * 2 + 24;
+    } else {
+        f.linesize[1] = f.linesize[2] = cw + 24;
+    }
+
+    // 随机值覆盖全部 0-255（包括超出有限范围、需要截断的组合）
+    std::mt19937 rng(seed);
+    int planeCount = format == AV_PIX_FMT_NV12 ? 2 : 3;
+    for (int i = 0; i < planeCount; ++i) {
+        int rows = i == 0 ? h : ch;
+        f.planes[i].resize(static_cast<size_t>(f.linesize[i]) * rows);
+        for (auto& b : f.planes[i]) b = static_cast<uint8_t>(rng());
+        f.data[i] = f.planes[i].data();
+    }
+    return f;
+}
+
+void convert(const TestFrame& f, uint8_t* dst, int dstStride, const YuvToRgbCoeffs& k, ConvertIsa isa)
+{
+    if (f.format == AV_PIX_FMT_NV12) {
+        ConvertNv12ToRgba(f.data, f.linesize, f.width, f.height, dst, dstStride, k, isa);
+    } else {
+        ConvertYuv420pToRgba(f.data, f.linesize, f.width, f.height, dst, dstStride, k, isa);
+    }
+}
+
+/* ---- 逐位校验 ---- */
+
+bool validate()
+{
+    const int sizes[][2] = { {16, 2}, {31, 3}, {32, 4}, {33, 5}, {47, 7}, {64, 2}, {100, 9}, {255, 17}, {1920, 8} };
+    const AVColorSpace spaces[] = { AVCOL_SPC_BT470BG, AVCOL_SPC_BT709, AVCOL_SPC_BT2020_NCL };
+    const AVPixelFormat formats[] = { AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12 };
+
+    int checked = 0;
+    bool ok = true;
+    uint32_t seed = 1;
+    for (AVPixelFormat fmt : formats) {
+        for (const auto& s : sizes) {
+            TestFrame f = makeFrame(fmt, s[0], s[1], seed++);
+            int stride = f.width * 4;
+            std::vector<uint8_t> ref(static_cast<size_t>(stride) * f.height);
+            std::vector<uint8_t> out(ref.size());
+
+            for (AVColorSpace cs : spaces) {
+                for (bool fullRange : {false, true}) {
+                    YuvToRgbCoeffs k = MakeYuvToRgbCoeffs(cs, fullRange, f.height);
+                    convert(f, ref.data(), stride, k, ConvertIsa::Scalar);
+
+                    for (ConvertIsa isa : ALL_ISAS) {
+                        if (isa == ConvertIsa::Scalar || !ConvertIsaSupported(isa)) continue;
+                        std::memset(out.data(), 0, out.size());
+                        convert(f, out.data(), stride, k, isa);
+                        ++checked;
+                        if (out == ref) continue;
+
+                        size_t i = 0;
+                        while (out[i] == ref[i]) ++i;
+                        std::cerr << "Mismatch: " << ConvertIsaName(isa) << " " << av_get_pix_fmt_name(fmt)
+                                  << " " << f.width << "x" << f.height << " cs=" << cs
+                                  << (fullRange ? " full" : " limited")
+                                  << " at pixel (" << (i % stride) / 4 << "," << i / stride << ")"
+                                  << " got " << int(out[i]) << " expected " << int(ref[i]) << "\n";
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "bit-exact check: " << checked << " cases " << (ok ? "passed" : "FAILED") << "\n";
+    return ok;
+}
+
+/* ---- 吞吐 ---- */
+
+template <typename Fn>
+double measure(int frames, int pixels, Fn&& fn)
+{
+    fn(0);   // 预热
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) fn(i);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(frames) * pixels / seconds / 1e6;
+}
+
+void report(const std::string& name, double mpix, double base)
+{
+    std::cout << "  " << std::left << std::setw(20) << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << mpix << " Mpix/s";
+    if (base > 0.0) std::cout << std::setw(8) << std::setprecision(2) << mpix / base << "x";
+    std::cout << "\n";
+}
+
+bool benchmark(AVPixelFormat fmt, int w, int h, int frames)
+{
+    // 几帧不同内容轮流转换，避免所有数据常驻 L1
+    std::vector<TestFrame> src;
+    for (int i = 0; i < 4; ++i) src.push_back(makeFrame(fmt, w, h, 100 + i));
+
+    int stride = w * 4;
+    std::vector<uint8_t> dst(static_cast<size_t>(stride) * h);
+    uint8_t* dstPlanes[4] = { dst.data(), nullptr, nullptr, nullptr };
+    int dstLinesize[4] = { stride, 0, 0, 0 };
+    YuvToRgbCoeffs k = MakeYuvToRgbCoeffs(AVCOL_SPC_BT709, false, h);
+
+    std::cout << av_get_pix_fmt_name(fmt) << " -> rgba " << w << "x" << h << ", " << frames << " frames\n";
+
+    double base = 0.0;
+    for (int flags : {SWS_BILINEAR, SWS_POINT}) {
+        SwsContext* sws = sws_getContext(w, h, fmt, w, h, AV_PIX_FMT_RGBA, flags, nullptr, nullptr, nullptr);
+        if (!sws) {
+            std::cerr << "sws_getContext failed\n";
+            return false;
+        }
+        double mpix = measure(frames, w * h, [&](int i) {
+            const TestFrame& f = src[i % src.size()];
+            sws_scale(sws, f.data, f.linesize, 0, h, dstPlanes, dstLinesize);
+        });
+        sws_freeContext(sws);
+        if (base == 0.0) base = mpix;
+        report(flags == SWS_BILINEAR ? "sws_scale bilinear" : "sws_scale point", mpix, base);
+    }
+
+    for (ConvertIsa isa : ALL_ISAS) {
+        if (!ConvertIsaSupported(isa)) continue;
+        double mpix = measure(frames, w * h, [&](int i) {
+            convert(src[i % src.size()], dst.data(), stride, k, isa);
+        });
+        report(ConvertIsaName(isa), mpix, base);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int w = 1920, h = 1080;
+    if (argc > 1 && std::sscanf(argv[1], "%dx%d", &w, &h) != 2) {
+        std::cerr << "Invalid size: " << argv[1] << "\n";
+        return 1;
+    }
+    int frames = argc > 2 ? std::atoi(argv[2]) : 200;
+    if (w <= 0 || h <= 0 || frames <= 0) {
+        std::cerr << "Invalid arguments\n";
+        return 1;
+    }
+
+    std::cout << "best isa: " << ConvertIsaName(ConvertIsa::Best) << "\n";
+    if (!validate()) return 1;
+
+    for (AVPixelFormat fmt : {AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12}) {
+        if (!benchmark(fmt, w, h, frames)) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+// SpscRing 与原先 std::queue + std::mutex 视频队列的对比微基准。
+// 一个生产者、一个消费者，外加一个模拟 Run()/跳帧阈值调整的观察线程不断读取队列长度。
+//
+// 用法: SpscRingBench [items]
+
+#include "Render/SpscRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace {
+
+constexpr size_t QUEUE_CAP = 48; // 与 MediaSession::MAX_VQ 一致
+
+// 与 FrameData（VideoFrame.h）大小相近的负载
+struct Item {
+    uint64_t seq = 0;
+    uint8_t* planes[3] = {nullptr, nullptr, nullptr};
+    int linesize[3] = {0, 0, 0};
+    int meta[8] = {};
+    double pts = 0.0;
+};
+
+// 原实现：有界 std::queue + 互斥锁
+class MutexQueue {
+public:
+    bool TryPush(const Item& v)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (q.size() >= QUEUE_CAP) return false;
+        q.push(v);
+        return true;
+    }
+
+    bool TryPop(Item& out)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (q.empty()) return false;
+        out = q.front();
+        q.pop();
+        return true;
+    }
+
+    size_t Size()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return q.size();
+    }
+
+private:
+    std::queue<Item> q;
+    std::mutex mtx;
+};
+
+struct Result {
+    double seconds = 0.0;
+    uint64_t checksum = 0;
+    uint64_t observed = 0;
+};
+
+template <typename Queue>
+Result runOnce(Queue& q, uint64_t items, bool withObserver)
+{
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> observed{0};
+    Result r;
+
+    std::thread observer;
+    if (withObserver) {
+        observer = std::thread([&] {
+            uint64_t n = 0, acc = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                acc += q.Size();
+                ++n;
+                std::this_thread::yield();
+            }
+            observed.store(n + (acc & 1));
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&] {
+        Item it;
+        for (uint64_t i = 0; i < items; ++i) {
+            it.seq = i;
+            it.pts = static_cast<double>(i);
+            while (!q.TryPush(it)) std::this_thread::yield();
+        }
+    });
+
+    uint64_t sum = 0;
+    Item it;
+    for (uint64_t i = 0; i < items; ++i) {
+        while (!q.TryPop(it)) std::this_thread::yield();
+        if (it.seq != i) {
+            std::cerr << "Order violation: expected " << i << " got " << it.seq << "\n";
+            std::exit(1);
+        }
+        sum += it.seq;
+    }
+
+    producer.join();
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    done = true;
+    if (observer.joinable()) observer.join();
+    r.checksum = sum;
+    r.observed = observed.load();
+    return r;
+}
+
+void report(const char* name, const Result& r, uint64_t items)
+{
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << items / r.seconds / 1e6 << " Mitems/s"
+              << std::setw(10) << r.seconds * 1e9 / items << " ns/item";
+    if (r.observed) std::cout << "   (size() reads: " << r.observed << ")";
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    uint64_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    const uint64_t expected = items * (items - 1) / 2;
+
+    std::cout << "SPSC queue benchmark, capacity " << QUEUE_CAP << ", " << items << " items\n";
+
+    for (bool observer : {false, true}) {
+        auto ring = std::make_unique<SpscRing<Item, QUEUE_CAP>>();
+        Result rr = runOnce(*ring, items, observer);
+
+        MutexQueue mq;
+        Result mr = runOnce(mq, items, observer);
+
+        if (rr.checksum != expected || mr.checksum != expected) {
+            std::cerr << "Checksum mismatch\n";
+            return 1;
+        }
+
+        std::cout << (observer ? "-- with size() observer --\n" : "-- producer/consumer --\n");
+        report("SpscRing", rr, items);
+        report("std::queue + std::mutex", mr, items);
+        std::cout << "speedup: " << std::setprecision(2) << mr.seconds / rr.seconds << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include "ColorConvert.h"
+#include "ColorConvertKernels.h"
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+
+#if defined(_MSC_VER) && defined(COLORCONVERT_X86)
+#include <intrin.h>
+#endif
+
+/* ---- 系数 ---- */
+
+YuvToRgbCoeffs MakeYuvToRgbCoeffs(AVColorSpace cs, bool fullRange, int height)
+{
+    // 未标注时按惯例：高清用 BT.709，标清用 BT.601
+    double kr, kb;
+    switch (cs) {
+        case AVCOL_SPC_BT709:
+            kr = 0.2126; kb = 0.0722;
+            break;
+        case AVCOL_SPC_BT2020_NCL:
+        case AVCOL_SPC_BT2020_CL:
+            kr = 0.2627; kb = 0.0593;
+            break;
+        case AVCOL_SPC_BT470BG:
+        case AVCOL_SPC_SMPTE170M:
+        case AVCOL_SPC_SMPTE240M:
+        case AVCOL_SPC_FCC:
+            kr = 0.299; kb = 0.114;
+            break;
+        default:
+            if (height >= 720) { kr = 0.2126; kb = 0.0722; }
+            else               { kr = 0.299;  kb = 0.114;  }
+            break;
+    }
+    double kg = 1.0 - kr - kb;
+
+    double ys = fullRange ? 1.0 : 255.0 / 219.0;
+    double cscale = fullRange ? 1.0 : 255.0 / 224.0;
+
+    auto q13 = [](double c) { return static_cast<int16_t>(std::lround(c * 8192.0)); };
+
+    YuvToRgbCoeffs k;
+    k.yOff = fullRange ? 0 : 16;
+    k.cy  = q13(ys);
+    k.crv = q13(cscale * 2.0 * (1.0 - kr));
+    k.cgu = q13(-cscale * 2.0 * kb * (1.0 - kb) / kg);
+    k.cgv = q13(-cscale * 2.0 * kr * (1.0 - kr) / kg);
+    k.cbu = q13(cscale * 2.0 * (1.0 - kb));
+    return k;
+}
+
+/* ---- 指令集选择 ---- */
+
+const char* ConvertIsaName(ConvertIsa isa)
+{
+    switch (isa) {
+        case ConvertIsa::Scalar: return "scalar";
+        case ConvertIsa::Sse41:  return "sse4.1";
+        case ConvertIsa::Avx2:   return "avx2";
+        case ConvertIsa::Neon:   return "neon";
+        case ConvertIsa::Best:   return ConvertIsaName(BestConvertIsa());
+    }
+    return "unknown";
+}
+
+bool ConvertIsaSupported(ConvertIsa isa)
+{
+    switch (isa) {
+        case ConvertIsa::Scalar:
+        case ConvertIsa::Best:
+            return true;
+#if defined(COLORCONVERT_X86) && defined(_MSC_VER)
+        case ConvertIsa::Sse41: {
+            int r[4];
+            __cpuid(r, 1);
+            return (r[2] & (1 << 19)) != 0;
+        }
+        case ConvertIsa::Avx2: {
+            // 还需要操作系统保存 YMM 寄存器（OSXSAVE + XCR0）
+            int r[4];
+            __cpuid(r, 1);
+            if ((r[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) return false;
+            __cpuidex(r, 7, 0);
+            return (r[1] & (1 << 5)) != 0;
+        }
+#elif defined(COLORCONVERT_X86)
+        case ConvertIsa::Sse41:
+            return __builtin_cpu_supports("sse4.1");
+        case ConvertIsa::Avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef COLORCONVERT_NEON
+        case ConvertIsa::Neon:
+            return true;   // AArch64 上 NEON 是基础指令集
+#endif
+        default:
+            return false;
+    }
+}
+
+ConvertIsa BestConvertIsa()
+{
+    static const ConvertIsa best = [] {
+        for (ConvertIsa isa : {ConvertIsa::Avx2, ConvertIsa::Sse41, ConvertIsa::Neon}) {
+            if (ConvertIsaSupported(isa)) return isa;
+        }
+        return ConvertIsa::Scalar;
+    }();
+    return best;
+}
+
+/* ---- 标量实现 ---- */
+
+static inline uint8_t clamp8(int v)
+{
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline void pixelToRgba(int y, int u, int v, uint8_t* dst, const YuvToRgbCoeffs& k)
+{
+    int yc = k.cy * (y - k.yOff) + 4096;
+    u -= 128;
+    v -= 128;
+    dst[0] = clamp8((yc + k.crv * v) >> 13);
+    dst[1] = clamp8((yc + k.cgu * u + k.cgv * v) >> 13);
+    dst[2] = clamp8((yc + k.cbu * u) >> 13);
+    dst[3] = 255;
+}
+
+// 从 x 开始补齐一行剩余的像素（x 为偶数）
+static void yuv420RowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                            int x, int width, const YuvToRgbCoeffs& k)
+{
+    for (; x < width; ++x) {
+        pixelToRgba(y[x], u[x >> 1], v[x >> 1], dst + x * 4, k);
+    }
+}
+
+static void nv12RowScalar(const uint8_t* y, const uint8_t* uv, uint8_t* dst,
+                          int x, int width, const YuvToRgbCoeffs& k)
+{
+    for (; x < width; ++x) {
+        const uint8_t* c = uv + (x >> 1) * 2;
+        pixelToRgba(y[x], c[0], c[1], dst + x * 4, k);
+    }
+}
+
+/* ---- 整帧转换 ---- */
+
+typedef int (*Yuv420RowFn)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, int, const YuvToRgbCoeffs&);
+typedef int (*Nv12RowFn)(const uint8_t*, const uint8_t*, uint8_t*, int, const YuvToRgbCoeffs&);
+
+// 不支持的指令集退回到最佳可用实现
+static ConvertIsa resolveIsa(ConvertIsa isa)
+{
+    if (isa == ConvertIsa::Best || !ConvertIsaSupported(isa)) return BestConvertIsa();
+    return isa;
+}
+
+static Yuv420RowFn yuv420RowFn(ConvertIsa isa)
+{
+    switch (resolveIsa(isa)) {
+#ifdef COLORCONVERT_X86
+        case ConvertIsa::Sse41: return colorconvert::Yuv420RowSse41;
+        case ConvertIsa::Avx2:  return colorconvert::Yuv420RowAvx2;
+#endif
+#ifdef COLORCONVERT_NEON
+        case ConvertIsa::Neon:  return colorconvert::Yuv420RowNeon;
+#endif
+        default:                return nullptr;
+    }
+}
+
+static Nv12RowFn nv12RowFn(ConvertIsa isa)
+{
+    switch (resolveIsa(isa)) {
+#ifdef COLORCONVERT_X86
+        case ConvertIsa::Sse41: return colorconvert::Nv12RowSse41;
+        case ConvertIsa::Avx2:  return colorconvert::Nv12RowAvx2;
+#endif
+#ifdef COLORCONVERT_NEON
+        case ConvertIsa::Neon:  return colorconvert::Nv12RowNeon;
+#endif
+        default:                return nullptr;
+    }
+}
+
+void ConvertYuv420pToRgba(const uint8_t* const src[3], const int srcStride[3], int width, int height,
+                          uint8_t* dst, int dstStride, const YuvToRgbCoeffs& k, ConvertIsa isa)
+{
+    Yuv420RowFn row = yuv420RowFn(isa);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* py = src[0] + static_cast<ptrdiff_t>(y) * srcStride[0];
+        const uint8_t* pu = src[1] + static_cast<ptrdiff_t>(y >> 1) * srcStride[1];
+        const uint8_t* pv = src[2] + static_cast<ptrdiff_t>(y >> 1) * srcStride[2];
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+
+        int done = row ? row(py, pu, pv, out, width, k) : 0;
+        yuv420RowScalar(py, pu, pv, out, done, width, k);
+    }
+}
+
+void ConvertNv12ToRgba(const uint8_t* const src[3], const int srcStride[3], int width, int height,
+                       uint8_t* dst, int dstStride, const YuvToRgbCoeffs& k, ConvertIsa isa)
+{
+    Nv12RowFn row = nv12RowFn(isa);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* py = src[0] + static_cast<ptrdiff_t>(y) * srcStride[0];
+        const uint8_t* puv = src[1] + static_cast<ptrdiff_t>(y >> 1) * srcStride[1];
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+
+        int done = row ? row(py, puv, out, width, k) : 0;
+        nv12RowScalar(py, puv, out, done, width, k);
+    }
+}
+
+bool ConvertFrameToRgba(const AVFrame* frame, uint8_t* dst, int dstStride, ConvertIsa isa)
+{
+    auto fmt = static_cast<AVPixelFormat>(frame->format);
+    if (fmt != AV_PIX_FMT_YUV420P && fmt != AV_PIX_FMT_YUVJ420P && fmt != AV_PIX_FMT_NV12) {
+        return false;
+    }
+
+    bool fullRange = frame->color_range == AVCOL_RANGE_JPEG || fmt == AV_PIX_FMT_YUVJ420P;
+    YuvToRgbCoeffs k = MakeYuvToRgbCoeffs(frame->colorspace, fullRange, frame->height);
+
+    const uint8_t* const src[3] = { frame->data[0], frame->data[1], frame->data[2] };
+    if (fmt == AV_PIX_FMT_NV12) {
+        ConvertNv12ToRgba(src, frame->linesize, frame->width, frame->height, dst, dstStride, k, isa);
+    } else {
+        ConvertYuv420pToRgba(src, frame->linesize, frame->width, frame->height, dst, dstStride, k, isa);
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef COLORCONVERT_H
+#define COLORCONVERT_H
+
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+// CPU 上的 YUV420P / NV12 → RGBA 同尺寸转换（截图、缩略图导出、纹理单元不足的 GL 驱动）。
+// 所有实现使用同一套 Q13 定点公式，SIMD 版本与标量版本逐位一致：
+//   y' = Y - yOff, u' = U - 128, v' = V - 128
+//   R = clamp((cy*y' + crv*v' + 4096) >> 13)
+//   G = clamp((cy*y' + cgu*u' + cgv*v' + 4096) >> 13)
+//   B = clamp((cy*y' + cbu*u' + 4096) >> 13)
+// 色度不做插值，每个 2x2 像素块共用一个色度样本。
+
+enum class ConvertIsa {
+    Scalar,
+    Sse41,
+    Avx2,
+    Neon,
+    Best    // 运行时选择当前 CPU 支持的最快实现
+};
+
+struct YuvToRgbCoeffs {
+    int16_t yOff = 16;
+    int16_t cy = 0, crv = 0, cgu = 0, cgv = 0, cbu = 0;   // Q13
+};
+
+// 按色彩空间（BT.601 / BT.709 / BT.2020）和范围生成系数，未指定时按高度猜测（与 GL 路径一致）
+YuvToRgbCoeffs MakeYuvToRgbCoeffs(AVColorSpace cs, bool fullRange, int height);
+
+const char* ConvertIsaName(ConvertIsa isa);
+bool        ConvertIsaSupported(ConvertIsa isa);
+ConvertIsa  BestConvertIsa();
+
+// src/srcStride：Y、U、V 三个平面（NV12 时 src[1] 为交错 UV，src[2] 忽略）；dst 为 width*height 个 RGBA 像素
+void ConvertYuv420pToRgba(const uint8_t* const src[3], const int srcStride[3], int width, int height,
+                          uint8_t* dst, int dstStride, const YuvToRgbCoeffs& k,
+                          ConvertIsa isa = ConvertIsa::Best);
+void ConvertNv12ToRgba(const uint8_t* const src[3], const int srcStride[3], int width, int height,
+                       uint8_t* dst, int dstStride, const YuvToRgbCoeffs& k,
+                       ConvertIsa isa = ConvertIsa::Best);
+
+// 按帧的像素格式和色彩信息转换；不是 YUV420P/YUVJ420P/NV12 时返回 false
+bool ConvertFrameToRgba(const AVFrame* frame, uint8_t* dst, int dstStride,
+                        ConvertIsa isa = ConvertIsa::Best);
+
+#endif
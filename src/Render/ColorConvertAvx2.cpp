@@ -0,0 +1,122 @@
+#include "ColorConvertKernels.h"
+
+#ifdef COLORCONVERT_X86
+#include <immintrin.h>
+
+namespace colorconvert {
+namespace {
+
+struct Avx2Consts {
+    __m256i yOff, c128, one;
+    __m256i yk, rk, gk, bk;   // 含义同 SSE4.1 版本
+};
+
+COLORCONVERT_TARGET("avx2")
+Avx2Consts makeConsts(const YuvToRgbCoeffs& k)
+{
+    Avx2Consts c;
+    c.yOff = _mm256_set1_epi16(k.yOff);
+    c.c128 = _mm256_set1_epi16(128);
+    c.one  = _mm256_set1_epi16(1);
+    c.yk = _mm256_set1_epi32((4096 << 16) | static_cast<uint16_t>(k.cy));
+    c.rk = _mm256_set1_epi32((static_cast<uint16_t>(k.crv) << 16));
+    c.gk = _mm256_set1_epi32((static_cast<uint16_t>(k.cgv) << 16) | static_cast<uint16_t>(k.cgu));
+    c.bk = _mm256_set1_epi32(static_cast<uint16_t>(k.cbu));
+    return c;
+}
+
+// 16 个像素的一个分量，按像素顺序输出 16 个 int16。
+// 256 位解包按 128 位通道进行：lo 为像素 0-3 | 8-11，hi 为像素 4-7 | 12-15，色度复制后的排列与之相同。
+COLORCONVERT_TARGET("avx2")
+inline __m256i component16(__m256i ylo, __m256i yhi, __m256i uv, __m256i k)
+{
+    __m256i t = _mm256_madd_epi16(uv, k);
+    __m256i lo = _mm256_add_epi32(ylo, _mm256_unpacklo_epi32(t, t));
+    __m256i hi = _mm256_add_epi32(yhi, _mm256_unpackhi_epi32(t, t));
+    return _mm256_packs_epi32(_mm256_srai_epi32(lo, 13), _mm256_srai_epi32(hi, 13));
+}
+
+struct Half {
+    __m256i r, g, b;   // 各 16 个 int16
+};
+
+// 16 个像素：y 为 16 个亮度样本，uv 为对应的 8 组交错色度样本
+COLORCONVERT_TARGET("avx2")
+inline Half convertHalf(__m128i y8, __m128i uv8, const Avx2Consts& c)
+{
+    __m256i y16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(y8), c.yOff);
+    __m256i ylo = _mm256_madd_epi16(_mm256_unpacklo_epi16(y16, c.one), c.yk);
+    __m256i yhi = _mm256_madd_epi16(_mm256_unpackhi_epi16(y16, c.one), c.yk);
+    __m256i uv = _mm256_sub_epi16(_mm256_cvtepu8_epi16(uv8), c.c128);
+
+    Half h;
+    h.r = component16(ylo, yhi, uv, c.rk);
+    h.g = component16(ylo, yhi, uv, c.gk);
+    h.b = component16(ylo, yhi, uv, c.bk);
+    return h;
+}
+
+// 两组 16 像素的 int16 合并为 32 个 uint8（按像素顺序）
+COLORCONVERT_TARGET("avx2")
+inline __m256i pack32(__m256i a, __m256i b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+}
+
+COLORCONVERT_TARGET("avx2")
+inline void store32(__m256i r, __m256i g, __m256i b, uint8_t* dst)
+{
+    __m256i a = _mm256_set1_epi8(static_cast<char>(0xFF));
+    __m256i rgl = _mm256_unpacklo_epi8(r, g), rgh = _mm256_unpackhi_epi8(r, g);
+    __m256i bal = _mm256_unpacklo_epi8(b, a), bah = _mm256_unpackhi_epi8(b, a);
+
+    __m256i p0 = _mm256_unpacklo_epi16(rgl, bal);   // 像素 0-3   | 16-19
+    __m256i p1 = _mm256_unpackhi_epi16(rgl, bal);   // 像素 4-7   | 20-23
+    __m256i p2 = _mm256_unpacklo_epi16(rgh, bah);   // 像素 8-11  | 24-27
+    __m256i p3 = _mm256_unpackhi_epi16(rgh, bah);   // 像素 12-15 | 28-31
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),      _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+COLORCONVERT_TARGET("avx2")
+inline void convert32(const uint8_t* y, __m128i uvA, __m128i uvB, uint8_t* dst, const Avx2Consts& c)
+{
+    Half a = convertHalf(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)), uvA, c);
+    Half b = convertHalf(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + 16)), uvB, c);
+    store32(pack32(a.r, b.r), pack32(a.g, b.g), pack32(a.b, b.b), dst);
+}
+
+} // namespace
+
+COLORCONVERT_TARGET("avx2")
+int Yuv420RowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const YuvToRgbCoeffs& k)
+{
+    const Avx2Consts c = makeConsts(k);
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m128i u16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x / 2));
+        __m128i v16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + x / 2));
+        convert32(y + x, _mm_unpacklo_epi8(u16, v16), _mm_unpackhi_epi8(u16, v16), dst + x * 4, c);
+    }
+    return x;
+}
+
+COLORCONVERT_TARGET("avx2")
+int Nv12RowAvx2(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, const YuvToRgbCoeffs& k)
+{
+    const Avx2Consts c = makeConsts(k);
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m128i uvA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x));
+        __m128i uvB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x + 16));
+        convert32(y + x, uvA, uvB, dst + x * 4, c);
+    }
+    return x;
+}
+
+} // namespace colorconvert
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef COLORCONVERTKERNELS_H
+#define COLORCONVERTKERNELS_H
+
+#include "ColorConvert.h"
+
+// ColorConvert 内部使用：各指令集的行转换函数。
+// 每个函数处理一行中尽可能多的完整块，返回已转换的像素数（偶数），剩余像素由标量代码补齐。
+// u、v 为两个独立色度平面；uv 为 NV12 的交错色度平面。
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define COLORCONVERT_X86 1
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define COLORCONVERT_NEON 1
+#endif
+
+// SIMD 函数逐个声明目标指令集，不依赖整个文件的编译选项（MSVC 无需声明即可使用这些指令）
+#if defined(__GNUC__) || defined(__clang__)
+#define COLORCONVERT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define COLORCONVERT_TARGET(isa)
+#endif
+
+namespace colorconvert {
+
+#ifdef COLORCONVERT_X86
+int Yuv420RowSse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const YuvToRgbCoeffs& k);
+int Nv12RowSse41(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, const YuvToRgbCoeffs& k);
+int Yuv420RowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const YuvToRgbCoeffs& k);
+int Nv12RowAvx2(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, const YuvToRgbCoeffs& k);
+#endif
+
+#ifdef COLORCONVERT_NEON
+int Yuv420RowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const YuvToRgbCoeffs& k);
+int Nv12RowNeon(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, const YuvToRgbCoeffs& k);
+#endif
+
+} // namespace colorconvert
+
+#endif
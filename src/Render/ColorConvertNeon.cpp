@@ -0,0 +1,85 @@
+#include "ColorConvertKernels.h"
+
+#ifdef COLORCONVERT_NEON
+#include <arm_neon.h>
+
+namespace colorconvert {
+namespace {
+
+// 4 个像素的一个分量：亮度项加上复制后的色度项，右移后收窄为 int16
+inline int16x4_t component4(int32x4_t yc, int32x4_t chroma)
+{
+    return vqmovn_s32(vshrq_n_s32(vaddq_s32(yc, chroma), 13));
+}
+
+// 16 个像素：y 为 16 个亮度样本，u、v 为对应的 8 个色度样本
+inline void convert16(uint8x16_t y8, uint8x8_t u8, uint8x8_t v8, uint8_t* dst, const YuvToRgbCoeffs& k)
+{
+    const int16x8_t yOff = vdupq_n_s16(k.yOff);
+    const int16x8_t c128 = vdupq_n_s16(128);
+    const int32x4_t round = vdupq_n_s32(4096);
+
+    int16x8_t yl = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8))), yOff);
+    int16x8_t yh = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8))), yOff);
+    int32x4_t yc[4] = {
+        vmlal_n_s16(round, vget_low_s16(yl), k.cy),
+        vmlal_n_s16(round, vget_high_s16(yl), k.cy),
+        vmlal_n_s16(round, vget_low_s16(yh), k.cy),
+        vmlal_n_s16(round, vget_high_s16(yh), k.cy),
+    };
+
+    int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), c128);
+    int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), c128);
+
+    // 每个色度样本的分量贡献（色度 0-3 与 4-7），再复制到相邻两个像素
+    int32x4_t rc[2] = { vmull_n_s16(vget_low_s16(v), k.crv), vmull_n_s16(vget_high_s16(v), k.crv) };
+    int32x4_t gc[2] = {
+        vmlal_n_s16(vmull_n_s16(vget_low_s16(u), k.cgu), vget_low_s16(v), k.cgv),
+        vmlal_n_s16(vmull_n_s16(vget_high_s16(u), k.cgu), vget_high_s16(v), k.cgv),
+    };
+    int32x4_t bc[2] = { vmull_n_s16(vget_low_s16(u), k.cbu), vmull_n_s16(vget_high_s16(u), k.cbu) };
+
+    int16x4_t r[4], g[4], b[4];
+    for (int i = 0; i < 2; ++i) {
+        int32x4x2_t rd = vzipq_s32(rc[i], rc[i]);
+        int32x4x2_t gd = vzipq_s32(gc[i], gc[i]);
+        int32x4x2_t bd = vzipq_s32(bc[i], bc[i]);
+        for (int j = 0; j < 2; ++j) {
+            r[i * 2 + j] = component4(yc[i * 2 + j], rd.val[j]);
+            g[i * 2 + j] = component4(yc[i * 2 + j], gd.val[j]);
+            b[i * 2 + j] = component4(yc[i * 2 + j], bd.val[j]);
+        }
+    }
+
+    uint8x16x4_t out;
+    out.val[0] = vcombine_u8(vqmovun_s16(vcombine_s16(r[0], r[1])), vqmovun_s16(vcombine_s16(r[2], r[3])));
+    out.val[1] = vcombine_u8(vqmovun_s16(vcombine_s16(g[0], g[1])), vqmovun_s16(vcombine_s16(g[2], g[3])));
+    out.val[2] = vcombine_u8(vqmovun_s16(vcombine_s16(b[0], b[1])), vqmovun_s16(vcombine_s16(b[2], b[3])));
+    out.val[3] = vdupq_n_u8(255);
+    vst4q_u8(dst, out);
+}
+
+} // namespace
+
+int Yuv420RowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const YuvToRgbCoeffs& k)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        convert16(vld1q_u8(y + x), vld1_u8(u + x / 2), vld1_u8(v + x / 2), dst + x * 4, k);
+    }
+    return x;
+}
+
+int Nv12RowNeon(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, const YuvToRgbCoeffs& k)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x8x2_t c = vld2_u8(uv + x);
+        convert16(vld1q_u8(y + x), c.val[0], c.val[1], dst + x * 4, k);
+    }
+    return x;
+}
+
+} // namespace colorconvert
+
+#endif
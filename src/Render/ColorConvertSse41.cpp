@@ -0,0 +1,121 @@
+#include "ColorConvertKernels.h"
+
+#ifdef COLORCONVERT_X86
+#include <immintrin.h>
+
+namespace colorconvert {
+namespace {
+
+struct Sse41Consts {
+    __m128i yOff, c128, one;
+    __m128i yk;    // (cy, 4096) 交错，与 (y', 1) 做 madd 得到 cy*y' + 4096
+    __m128i rk;    // (0, crv)    与 (u', v') 做 madd
+    __m128i gk;    // (cgu, cgv)
+    __m128i bk;    // (cbu, 0)
+};
+
+COLORCONVERT_TARGET("sse4.1")
+Sse41Consts makeConsts(const YuvToRgbCoeffs& k)
+{
+    Sse41Consts c;
+    c.yOff = _mm_set1_epi16(k.yOff);
+    c.c128 = _mm_set1_epi16(128);
+    c.one  = _mm_set1_epi16(1);
+    c.yk = _mm_set1_epi32((4096 << 16) | static_cast<uint16_t>(k.cy));
+    c.rk = _mm_set1_epi32((static_cast<uint16_t>(k.crv) << 16));
+    c.gk = _mm_set1_epi32((static_cast<uint16_t>(k.cgv) << 16) | static_cast<uint16_t>(k.cgu));
+    c.bk = _mm_set1_epi32(static_cast<uint16_t>(k.cbu));
+    return c;
+}
+
+// 4 个色度样本（u',v' 交错的 int16）的分量贡献，复制到 8 个像素
+COLORCONVERT_TARGET("sse4.1")
+inline void chromaTerms(__m128i uv, __m128i k, __m128i& lo, __m128i& hi)
+{
+    __m128i t = _mm_madd_epi16(uv, k);
+    lo = _mm_unpacklo_epi32(t, t);   // 像素 0-3
+    hi = _mm_unpackhi_epi32(t, t);   // 像素 4-7
+}
+
+COLORCONVERT_TARGET("sse4.1")
+inline __m128i pack16(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    __m128i lo = _mm_packs_epi32(_mm_srai_epi32(a, 13), _mm_srai_epi32(b, 13));
+    __m128i hi = _mm_packs_epi32(_mm_srai_epi32(c, 13), _mm_srai_epi32(d, 13));
+    return _mm_packus_epi16(lo, hi);
+}
+
+// 16 个像素：y 为 16 个亮度样本，uv 为对应的 8 组交错色度样本
+COLORCONVERT_TARGET("sse4.1")
+inline void convert16(__m128i y8, __m128i uv8, uint8_t* dst, const Sse41Consts& c)
+{
+    // 亮度项 cy*y' + 4096，每 4 个像素一组
+    __m128i yl = _mm_sub_epi16(_mm_cvtepu8_epi16(y8), c.yOff);
+    __m128i yh = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(y8, 8)), c.yOff);
+    __m128i y0 = _mm_madd_epi16(_mm_unpacklo_epi16(yl, c.one), c.yk);
+    __m128i y1 = _mm_madd_epi16(_mm_unpackhi_epi16(yl, c.one), c.yk);
+    __m128i y2 = _mm_madd_epi16(_mm_unpacklo_epi16(yh, c.one), c.yk);
+    __m128i y3 = _mm_madd_epi16(_mm_unpackhi_epi16(yh, c.one), c.yk);
+
+    // 色度 u' v'
+    __m128i uvl = _mm_sub_epi16(_mm_cvtepu8_epi16(uv8), c.c128);
+    __m128i uvh = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(uv8, 8)), c.c128);
+
+    __m128i t0, t1, t2, t3;
+    chromaTerms(uvl, c.rk, t0, t1);
+    chromaTerms(uvh, c.rk, t2, t3);
+    __m128i r = pack16(_mm_add_epi32(y0, t0), _mm_add_epi32(y1, t1),
+                       _mm_add_epi32(y2, t2), _mm_add_epi32(y3, t3));
+
+    chromaTerms(uvl, c.gk, t0, t1);
+    chromaTerms(uvh, c.gk, t2, t3);
+    __m128i g = pack16(_mm_add_epi32(y0, t0), _mm_add_epi32(y1, t1),
+                       _mm_add_epi32(y2, t2), _mm_add_epi32(y3, t3));
+
+    chromaTerms(uvl, c.bk, t0, t1);
+    chromaTerms(uvh, c.bk, t2, t3);
+    __m128i b = pack16(_mm_add_epi32(y0, t0), _mm_add_epi32(y1, t1),
+                       _mm_add_epi32(y2, t2), _mm_add_epi32(y3, t3));
+
+    // 交错为 RGBA
+    __m128i a = _mm_set1_epi8(static_cast<char>(0xFF));
+    __m128i rgl = _mm_unpacklo_epi8(r, g), rgh = _mm_unpackhi_epi8(r, g);
+    __m128i bal = _mm_unpacklo_epi8(b, a), bah = _mm_unpackhi_epi8(b, a);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),      _mm_unpacklo_epi16(rgl, bal));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(rgl, bal));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_unpacklo_epi16(rgh, bah));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_unpackhi_epi16(rgh, bah));
+}
+
+} // namespace
+
+COLORCONVERT_TARGET("sse4.1")
+int Yuv420RowSse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const YuvToRgbCoeffs& k)
+{
+    const Sse41Consts c = makeConsts(k);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+        __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+        __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        convert16(y8, _mm_unpacklo_epi8(u8, v8), dst + x * 4, c);
+    }
+    return x;
+}
+
+COLORCONVERT_TARGET("sse4.1")
+int Nv12RowSse41(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, const YuvToRgbCoeffs& k)
+{
+    const Sse41Consts c = makeConsts(k);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i uv8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x));
+        __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        convert16(y8, uv8, dst + x * 4, c);
+    }
+    return x;
+}
+
+} // namespace colorconvert
+
+#endif
@@ -0,0 +1,151 @@
+#include "DecodeThreadBench.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+}
+
+/* ---- 单次解码测量 ---- */
+static bool decodeAll(const AVStream* stream, const std::vector<AVPacket*>& packets,
+                      int threads, DecodeThreadType type,
+                      double& fps, int& frames, int& activeThreads, int& activeType)
+{
+    const AVCodec* decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!decoder) {
+        std::cerr << "Unsupported video codec\n";
+        return false;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(decoder);
+    if (!ctx || avcodec_parameters_to_context(ctx, stream->codecpar) < 0) {
+        std::cerr << "Failed to set up video codec context\n";
+        avcodec_free_context(&ctx);
+        return false;
+    }
+
+    ctx->thread_count = threads;
+    ctx->thread_type = DecodeThreadTypeFlags(type);
+
+    if (avcodec_open2(ctx, decoder, nullptr) < 0) {
+        std::cerr << "Failed to open video codec\n";
+        avcodec_free_context(&ctx);
+        return false;
+    }
+    activeThreads = ctx->thread_count;
+    activeType = ctx->active_thread_type;
+
+    AVFrame* frame = av_frame_alloc();
+    frames = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto drain = [&] {
+        while (avcodec_receive_frame(ctx, frame) >= 0) {
+            frames++;
+            av_frame_unref(frame);
+        }
+    };
+    for (AVPacket* p : packets) {
+        if (avcodec_send_packet(ctx, p) < 0) continue;
+        drain();
+    }
+    avcodec_send_packet(ctx, nullptr);
+    drain();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fps = seconds > 0 ? frames / seconds : 0.0;
+
+    av_frame_free(&frame);
+    avcodec_free_context(&ctx);
+    return true;
+}
+
+/* ---- 线程数扫描 ---- */
+int RunDecodeThreadBench(const std::string& file, DecodeThreadType type,
+                         int maxThreads, int maxPackets)
+{
+    AVFormatContext* fmt = nullptr;
+    if (avformat_open_input(&fmt, file.c_str(), nullptr, nullptr) < 0) {
+        std::cerr << "Failed to open input file: " << file << "\n";
+        return 1;
+    }
+    if (avformat_find_stream_info(fmt, nullptr) < 0) {
+        std::cerr << "Failed to find stream info\n";
+        avformat_close_input(&fmt);
+        return 1;
+    }
+
+    int vIdx = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (vIdx < 0) {
+        std::cerr << "No video stream found\n";
+        avformat_close_input(&fmt);
+        return 1;
+    }
+
+    // 预读视频包，排除 I/O 对解码测量的影响
+    std::vector<AVPacket*> packets;
+    AVPacket* pkt = av_packet_alloc();
+    while (static_cast<int>(packets.size()) < maxPackets && av_read_frame(fmt, pkt) >= 0) {
+        if (pkt->stream_index == vIdx) {
+            packets.push_back(av_packet_clone(pkt));
+        }
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+
+    if (maxThreads <= 0) {
+        maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // 1, 2, 4, ... 直到核数，最后加上自动（0）
+    std::vector<int> counts;
+    for (int n = 1; n < maxThreads; n *= 2) counts.push_back(n);
+    counts.push_back(maxThreads);
+    counts.push_back(0);
+
+    AVStream* stream = fmt->streams[vIdx];
+    std::cout << "Decode thread benchmark: " << file << "\n"
+              << "  codec " << avcodec_find_decoder(stream->codecpar->codec_id)->name
+              << ", " << stream->codecpar->width << "x" << stream->codecpar->height
+              << ", " << packets.size() << " packets, thread type " << DecodeThreadTypeName(type) << "\n";
+    std::cout << std::left << std::setw(12) << "requested" << std::setw(10) << "active"
+              << std::setw(10) << "mode" << std::setw(10) << "frames" << "fps\n";
+
+    int rc = 0;
+    double bestFps = 0.0;
+    int bestThreads = 0;
+    for (int n : counts) {
+        double fps = 0.0;
+        int frames = 0, active = 0, activeType = 0;
+        if (!decodeAll(stream, packets, n, type, fps, frames, active, activeType)) {
+            rc = 1;
+            break;
+        }
+
+        const char* mode = (activeType & FF_THREAD_FRAME) ? "frame"
+                         : (activeType & FF_THREAD_SLICE) ? "slice" : "none";
+        std::cout << std::left << std::setw(12) << (n == 0 ? std::string("auto") : std::to_string(n))
+                  << std::setw(10) << active << std::setw(10) << mode << std::setw(10) << frames
+                  << std::fixed << std::setprecision(1) << fps << "\n";
+
+        if (fps > bestFps) {
+            bestFps = fps;
+            bestThreads = n;
+        }
+    }
+
+    if (rc == 0) {
+        std::cout << "Best: " << (bestThreads == 0 ? std::string("auto") : std::to_string(bestThreads))
+                  << " threads (" << std::fixed << std::setprecision(1) << bestFps << " fps)\n";
+    }
+
+    for (AVPacket*& p : packets) av_packet_free(&p);
+    avformat_close_input(&fmt);
+    return rc;
+}
@@ -0,0 +1,13 @@
+#ifndef DECODETHREADBENCH_H
+#define DECODETHREADBENCH_H
+
+#include <string>
+#include "PlayerOptions.h"
+
+// 测量给定文件在不同解码线程数下的视频解码帧率，用于为每台主机选择合适的线程配置。
+// 先把最多 maxPackets 个视频包读入内存，再对每种线程数分别完整解码一遍，排除 I/O 影响。
+// 返回 0 表示成功。
+int RunDecodeThreadBench(const std::string& file, DecodeThreadType type,
+                         int maxThreads = 0, int maxPackets = 1500);
+
+#endif
@@ -0,0 +1,104 @@
+#include "DecoderArena.h"
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+void DecoderArena::Attach(AVCodecContext* ctx, int slotCount)
+{
+    slots = slotCount;
+    ctx->opaque = this;
+    ctx->get_buffer2 = getBuffer2;
+}
+
+void DecoderArena::Destroy()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    pool.Destroy();
+    slots = 0;
+}
+
+int DecoderArena::getBuffer2(AVCodecContext* ctx, AVFrame* frame, int flags)
+{
+    auto* self = static_cast<DecoderArena*>(ctx->opaque);
+    if (self && self->allocFrame(ctx, frame) == 0) {
+        return 0;
+    }
+
+    if (self) self->defaultAllocs.fetch_add(1, std::memory_order_relaxed);
+    return avcodec_default_get_buffer2(ctx, frame, flags);
+}
+
+void DecoderArena::freeBuffer(void* opaque, uint8_t* data)
+{
+    static_cast<DecoderArena*>(opaque)->pool.Release(data);
+}
+
+int DecoderArena::allocFrame(AVCodecContext* ctx, AVFrame* frame)
+{
+    // 不支持直接渲染的解码器、硬件帧和调色板格式交给默认分配器
+    auto pixFmt = static_cast<AVPixelFormat>(frame->format);
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(pixFmt);
+    if (!desc || !(ctx->codec->capabilities & AV_CODEC_CAP_DR1) || ctx->hw_frames_ctx ||
+        (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL))) {
+        return -1;
+    }
+
+    // 按解码器要求对齐宽高和行宽（与 FFmpeg 默认分配器的做法一致）
+    int w = frame->width;
+    int h = frame->height;
+    int strideAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(ctx, &w, &h, strideAlign);
+
+    int linesize[4] = {};
+    bool unaligned;
+    do {
+        if (av_image_fill_linesizes(linesize, pixFmt, w) < 0) return -1;
+        w += w & ~(w - 1);
+        unaligned = false;
+        for (int i = 0; i < 4; ++i) {
+            if (strideAlign[i] > 0 && linesize[i] % strideAlign[i]) unaligned = true;
+        }
+    } while (unaligned);
+
+    ptrdiff_t lines[4];
+    for (int i = 0; i < 4; ++i) lines[i] = linesize[i];
+    size_t planeSize[4] = {};
+    if (av_image_fill_plane_sizes(planeSize, pixFmt, h, lines) < 0) return -1;
+
+    // 各平面依次放在同一个槽位中，起点按缓存行对齐，末尾留出 SIMD 越界读取的余量
+    size_t offset[4] = {};
+    size_t total = 0;
+    for (int i = 0; i < 4; ++i) {
+        offset[i] = total;
+        if (planeSize[i]) {
+            total += (planeSize[i] + 16 + FramePool::ALIGN - 1) / FramePool::ALIGN * FramePool::ALIGN;
+        }
+    }
+
+    {
+        // 第一帧确定槽位大小；之后尺寸变大的帧由池退回堆分配
+        std::lock_guard<std::mutex> lock(mtx);
+        if (pool.SlotCount() == 0 && slots > 0 && !pool.Init(total, slots)) {
+            return -1;
+        }
+    }
+
+    uint8_t* buf = pool.Acquire(total);
+    if (!buf) return -1;
+
+    frame->buf[0] = av_buffer_create(buf, total, freeBuffer, this, 0);
+    if (!frame->buf[0]) {
+        pool.Release(buf);
+        return -1;
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        frame->data[i] = planeSize[i] ? buf + offset[i] : nullptr;
+        frame->linesize[i] = planeSize[i] ? linesize[i] : 0;
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
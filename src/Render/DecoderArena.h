@@ -0,0 +1,48 @@
+#ifndef DECODERARENA_H
+#define DECODERARENA_H
+
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "FramePool.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// 视频解码器的自定义 get_buffer2：解码器直接把像素写进我们自己的对齐内存池，
+// 渲染线程按引用拿到的就是这块内存，上传时无需再经过 FFmpeg 内部缓冲池。
+// 槽位大小在第一次分配时按解码器要求的对齐和尺寸确定；尺寸变化、硬件帧或不支持 DR1 的解码器
+// 退回 avcodec_default_get_buffer2。空闲槽位后进先出，长期只会触及峰值数量的槽位。
+class DecoderArena {
+public:
+    DecoderArena() = default;
+    ~DecoderArena() = default;
+
+    DecoderArena(const DecoderArena&) = delete;
+    DecoderArena& operator=(const DecoderArena&) = delete;
+
+    // 安装到解码器上下文（avcodec_open2 之前调用）；slots 为池中槽位数
+    void Attach(AVCodecContext* ctx, int slots);
+    // 必须在解码器释放、所有帧引用归还之后调用
+    void Destroy();
+
+    size_t   SlotSize()  const { std::lock_guard<std::mutex> lock(mtx); return pool.SlotSize(); }
+    int      SlotCount() const { std::lock_guard<std::mutex> lock(mtx); return pool.SlotCount(); }
+    int      HighWater() const { return pool.HighWater(); }
+    uint64_t HeapAllocs() const { return pool.HeapAllocs(); }
+    uint64_t DefaultAllocs() const { return defaultAllocs.load(std::memory_order_relaxed); }
+
+private:
+    static int  getBuffer2(AVCodecContext* ctx, AVFrame* frame, int flags);
+    static void freeBuffer(void* opaque, uint8_t* data);
+    int allocFrame(AVCodecContext* ctx, AVFrame* frame);
+
+    mutable std::mutex mtx;  // 保护槽位大小的首次确定
+    FramePool  pool;
+    int        slots = 0;
+    std::atomic<uint64_t> defaultAllocs{0};  // 退回默认分配器的次数
+};
+
+#endif
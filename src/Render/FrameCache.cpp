@@ -0,0 +1,147 @@
+#include "FrameCache.h"
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+FrameCache::~FrameCache()
+{
+    Clear();
+    if (sws) sws_freeContext(sws);
+    sws = nullptr;
+}
+
+void FrameCache::Configure(size_t budgetBytes, int scaleDiv, bool compact)
+{
+    Clear();
+    budget = budgetBytes;
+    scale = std::max(1, scaleDiv);
+    yuv420 = compact;
+}
+
+void FrameCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& kv : entries) av_frame_free(&kv.second.frame);
+    entries.clear();
+    lruOrder.clear();
+    bytes.store(0, std::memory_order_relaxed);
+}
+
+bool FrameCache::Contains(double pts) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return entries.count(pts) != 0;
+}
+
+int FrameCache::Count() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return static_cast<int>(entries.size());
+}
+
+/* ---- 插入（视频解码阶段） ---- */
+bool FrameCache::Insert(const AVFrame* frame, double pts, AVPixelFormat srcFmt, AVPixelFormat dstFmt, AVColorRange range)
+{
+    if (!Enabled() || pts < 0 || Contains(pts)) return false;
+    if (yuv420 && dstFmt != AV_PIX_FMT_NV12) dstFmt = AV_PIX_FMT_YUV420P;
+
+    // 拷贝 / 转换在锁外进行，渲染线程的 Find 不等待
+    AVFrame* copy = makeCopy(frame, srcFmt, dstFmt);
+    if (!copy) return false;
+    copy->color_range = range;
+    const AVPixFmtDescriptor* srcDesc = av_pix_fmt_desc_get(srcFmt);
+    if (dstFmt != AV_PIX_FMT_RGB24 && srcDesc && (srcDesc->flags & AV_PIX_FMT_FLAG_RGB)) {
+        // RGB 源经 sws 默认系数转为 YUV
+        copy->colorspace = AVCOL_SPC_SMPTE170M;
+        copy->color_range = AVCOL_RANGE_MPEG;
+    }
+
+    size_t size = 0;
+    for (AVBufferRef* buf : copy->buf) {
+        if (buf) size += buf->size;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto inserted = entries.emplace(pts, Entry());
+    if (!inserted.second) {
+        av_frame_free(&copy);
+        return false;
+    }
+    lruOrder.push_front(pts);
+    inserted.first->second.frame = copy;
+    inserted.first->second.size = size;
+    inserted.first->second.lru = lruOrder.begin();
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    evictLocked();
+    return true;
+}
+
+AVFrame* FrameCache::makeCopy(const AVFrame* frame, AVPixelFormat srcFmt, AVPixelFormat dstFmt)
+{
+    int w = frame->width, h = frame->height;
+    if (scale > 1) {
+        w = std::max(2, (w / scale) & ~1);
+        h = std::max(2, (h / scale) & ~1);
+    }
+
+    AVFrame* copy = av_frame_alloc();
+    if (!copy) return nullptr;
+    copy->format = dstFmt;
+    copy->width = w;
+    copy->height = h;
+    // RGB24 紧凑排列：纹理上传按 linesize / 3 设置行长，行宽必须是像素的整数倍
+    int align = dstFmt == AV_PIX_FMT_RGB24 ? 1 : 0;
+    if (av_frame_get_buffer(copy, align) < 0 || av_frame_copy_props(copy, frame) < 0) {
+        av_frame_free(&copy);
+        return nullptr;
+    }
+
+    if (srcFmt == dstFmt && w == frame->width && h == frame->height) {
+        av_image_copy(copy->data, copy->linesize, const_cast<const uint8_t**>(frame->data), frame->linesize,
+                      dstFmt, w, h);
+        return copy;
+    }
+
+    sws = sws_getCachedContext(sws, frame->width, frame->height, srcFmt,
+                               w, h, dstFmt,
+                               SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!sws) {
+        av_frame_free(&copy);
+        return nullptr;
+    }
+    sws_scale(sws, frame->data, frame->linesize, 0, frame->height, copy->data, copy->linesize);
+    return copy;
+}
+
+// 至少保留刚插入的一帧，预算小于单帧时缓存退化为只有最近一帧
+void FrameCache::evictLocked()
+{
+    while (bytes.load(std::memory_order_relaxed) > budget && entries.size() > 1) {
+        auto it = entries.find(lruOrder.back());
+        lruOrder.pop_back();
+        bytes.fetch_sub(it->second.size, std::memory_order_relaxed);
+        av_frame_free(&it->second.frame);
+        entries.erase(it);
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/* ---- 查找（渲染线程） ---- */
+AVFrame* FrameCache::Find(double pts, double tolerance)
+{
+    if (!Enabled()) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto best = entries.end();
+    for (auto it = entries.lower_bound(pts - tolerance); it != entries.end() && it->first <= pts + tolerance; ++it) {
+        if (best == entries.end() || std::abs(it->first - pts) < std::abs(best->first - pts)) best = it;
+    }
+    if (best == entries.end()) return nullptr;
+
+    lruOrder.splice(lruOrder.begin(), lruOrder, best->second.lru);
+    return av_frame_clone(best->second.frame);
+}
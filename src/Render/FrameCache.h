@@ -0,0 +1,74 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <atomic>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+// 播放头附近已解码帧的缓存：按 PTS 保存独立的像素副本（不占用解码器内存池），总字节数超过预算时
+// 淘汰最久未使用的帧。副本可按 scale 缩小，或统一存为 4:2:0 以节省内存。
+// Insert 只由视频解码阶段调用（同一时刻只有一个调用方），Find 在渲染线程调用；
+// Find 返回的是帧的新引用，之后被淘汰也不影响正在上传的帧
+class FrameCache {
+public:
+    FrameCache() = default;
+    ~FrameCache();
+
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+
+    // budgetBytes 为 0 时关闭缓存；scale 为副本的缩小倍数（1 = 原尺寸）
+    void Configure(size_t budgetBytes, int scale, bool yuv420);
+    void Clear();
+
+    bool Enabled() const { return budget > 0; }
+    bool Contains(double pts) const;
+
+    // 按 srcFmt 解释 frame 的平面（全范围 J 格式按同布局的有限范围格式传入，range 单独标记），
+    // 转换为 dstFmt 的副本；yuv420 时 dstFmt 被替换为 4:2:0（NV12 保持不变）。
+    // 返回是否新增了副本：缓存关闭、pts 已缓存或分配失败时返回 false
+    bool Insert(const AVFrame* frame, double pts, AVPixelFormat srcFmt, AVPixelFormat dstFmt, AVColorRange range);
+
+    // 与 pts 相差不超过 tolerance 的最近一帧，返回调用方负责释放的引用；没有时返回 nullptr
+    AVFrame* Find(double pts, double tolerance);
+
+    size_t   Bytes() const { return bytes.load(std::memory_order_relaxed); }
+    size_t   Budget() const { return budget; }
+    int      Count() const;
+    int      Scale() const { return scale; }
+    bool     Yuv420() const { return yuv420; }
+    uint64_t Evictions() const { return evictions.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        AVFrame* frame = nullptr;
+        size_t   size = 0;
+        std::list<double>::iterator lru;
+    };
+
+    AVFrame* makeCopy(const AVFrame* frame, AVPixelFormat srcFmt, AVPixelFormat dstFmt);
+    void     evictLocked();
+
+    size_t budget = 0;
+    int    scale = 1;
+    bool   yuv420 = false;
+
+    std::map<double, Entry> entries;   // 按 PTS 升序
+    std::list<double> lruOrder;        // 队首为最近使用
+    mutable std::mutex mtx;
+    SwsContext* sws = nullptr;         // 仅 Insert 使用
+
+    std::atomic<size_t>   bytes{0};
+    std::atomic<uint64_t> evictions{0};
+};
+
+#endif
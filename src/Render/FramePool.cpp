@@ -0,0 +1,92 @@
+#include "FramePool.h"
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+FramePool::~FramePool() { Destroy(); }
+
+bool FramePool::Init(size_t size, int count)
+{
+    Destroy();
+    if (size == 0 || count <= 0) return false;
+
+    // 每个槽位按缓存行对齐，便于 sws_scale / 纹理上传走 SIMD 路径
+    slotSize  = (size + ALIGN - 1) / ALIGN * ALIGN;
+    slotCount = count;
+
+    arena = static_cast<uint8_t*>(av_malloc(slotSize * slotCount));
+    if (!arena) {
+        slotSize = 0;
+        slotCount = 0;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    freeList.reserve(slotCount);
+    for (int i = slotCount - 1; i >= 0; --i) {
+        freeList.push_back(arena + i * slotSize);
+    }
+    return true;
+}
+
+void FramePool::Destroy()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    freeList.clear();
+    highWater = 0;
+    if (arena) av_free(arena);
+    arena = nullptr;
+    slotSize = 0;
+    slotCount = 0;
+}
+
+uint8_t* FramePool::Acquire(size_t size, Source* source)
+{
+    if (size <= slotSize) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!freeList.empty()) {
+            uint8_t* buf = freeList.back();
+            freeList.pop_back();
+            highWater = std::max(highWater, slotCount - static_cast<int>(freeList.size()));
+            if (source) *source = Source::Pool;
+            return buf;
+        }
+    }
+
+    // 回退到堆分配
+    bool exhausted = size <= slotSize;
+    if (exhausted) exhaustions.fetch_add(1, std::memory_order_relaxed);
+    heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    if (source) *source = exhausted ? Source::HeapExhausted : Source::HeapOversize;
+    return static_cast<uint8_t*>(av_malloc(size));
+}
+
+void FramePool::Release(uint8_t* buf)
+{
+    if (!buf) return;
+    if (!owns(buf)) {
+        av_free(buf);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    freeList.push_back(buf);
+}
+
+int FramePool::FreeCount()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return static_cast<int>(freeList.size());
+}
+
+int FramePool::HighWater() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return highWater;
+}
+
+bool FramePool::owns(const uint8_t* buf) const
+{
+    return arena && buf >= arena && buf < arena + slotSize * slotCount;
+}
@@ -0,0 +1,60 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+// 固定数量、固定大小的对齐帧缓冲池。
+// 解码线程 Acquire 后直接写入像素，渲染线程上传完成后 Release 归还；
+// 所有槽位来自一次性分配的连续内存，稳态播放期间不再产生堆分配。
+class FramePool {
+public:
+    static constexpr size_t ALIGN = 64;
+
+    // 缓冲区来源，便于调用方统计
+    enum class Source {
+        Pool,          // 来自池中槽位
+        HeapOversize,  // 请求尺寸超过槽位大小（例如中途分辨率变大）
+        HeapExhausted  // 池已耗尽
+    };
+
+    FramePool() = default;
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    bool Init(size_t slotSize, int slotCount);
+    void Destroy();
+
+    // 池耗尽或尺寸超出槽位时退回堆分配，返回值永远可用（除非内存不足）
+    uint8_t* Acquire(size_t size, Source* source = nullptr);
+    void     Release(uint8_t* buf);
+
+    size_t SlotSize()  const { return slotSize; }
+    int    SlotCount() const { return slotCount; }
+    int    FreeCount();
+    int    HighWater() const;   // 同时占用的槽位数峰值，用于按流确定池容量
+
+    uint64_t HeapAllocs()  const { return heapAllocs.load(std::memory_order_relaxed); }
+    uint64_t Exhaustions() const { return exhaustions.load(std::memory_order_relaxed); }
+
+private:
+    bool owns(const uint8_t* buf) const;
+
+    uint8_t* arena = nullptr;
+    size_t   slotSize = 0;
+    int      slotCount = 0;
+
+    std::vector<uint8_t*> freeList;
+    mutable std::mutex mtx;
+    int highWater = 0;
+
+    std::atomic<uint64_t> heapAllocs{0};
+    std::atomic<uint64_t> exhaustions{0};
+};
+
+#endif
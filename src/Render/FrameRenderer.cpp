@@ -0,0 +1,286 @@
+#include "FrameRenderer.h"
+#include <algorithm>
+#include <iostream>
+
+/* ========== GLSL ========== */
+static const char* vsrc = R"(#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec2 aUV;
+out vec2 UV;
+void main(){
+    gl_Position = vec4(aPos, 1.0);
+    UV = aUV;
+})";
+
+// uFormat: 0 = RGB24, 1 = YUV 三平面, 2 = NV12（与 FrameFormat 一致）
+// YUV -> RGB 的矩阵和量化范围由 CPU 端根据 AVFrame 的 colorspace/color_range 计算后传入，
+// 色度上采样依靠半分辨率色度纹理的 GL_LINEAR 双线性插值，uChromaOffset 用于校正左对齐的色度采样位置
+static const char* fsrc = R"(#version 330 core
+in vec2 UV;
+out vec4 FragColor;
+uniform sampler2D tex0;
+uniform sampler2D tex1;
+uniform sampler2D tex2;
+uniform int  uFormat;
+uniform mat3 uYuvMat;
+uniform vec3 uYuvOffset;
+uniform vec2 uChromaOffset;
+void main(){
+    if (uFormat == 0) {
+        FragColor = texture(tex0, UV);
+        return;
+    }
+    vec2 cUV = UV + uChromaOffset;
+    vec3 yuv;
+    yuv.x = texture(tex0, UV).r;
+    if (uFormat == 2) {
+        yuv.yz = texture(tex1, cUV).rg;
+    } else {
+        yuv.y = texture(tex1, cUV).r;
+        yuv.z = texture(tex2, cUV).r;
+    }
+    vec3 rgb = uYuvMat * (yuv - uYuvOffset);
+    FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+})";
+
+/* ========== YUV 辅助 ========== */
+// 计算列主序的 YUV -> RGB 矩阵（已包含量化范围缩放）以及各分量偏移
+static void buildYuvMatrix(AVColorSpace cs, bool fullRange, int height,
+                           float mat[9], float offset[3])
+{
+    // 未标注时按惯例：高清用 BT.709，标清用 BT.601
+    double kr, kb;
+    switch (cs) {
+        case AVCOL_SPC_BT709:
+            kr = 0.2126; kb = 0.0722;
+            break;
+        case AVCOL_SPC_BT2020_NCL:
+        case AVCOL_SPC_BT2020_CL:
+            kr = 0.2627; kb = 0.0593;
+            break;
+        case AVCOL_SPC_BT470BG:
+        case AVCOL_SPC_SMPTE170M:
+        case AVCOL_SPC_SMPTE240M:
+        case AVCOL_SPC_FCC:
+            kr = 0.299; kb = 0.114;
+            break;
+        default:
+            if (height >= 720) { kr = 0.2126; kb = 0.0722; }
+            else               { kr = 0.299;  kb = 0.114;  }
+            break;
+    }
+    double kg = 1.0 - kr - kb;
+
+    double ys = fullRange ? 1.0 : 255.0 / 219.0;
+    double cscale = fullRange ? 1.0 : 255.0 / 224.0;
+
+    // 第 0 列：Y，第 1 列：Cb，第 2 列：Cr
+    mat[0] = static_cast<float>(ys);
+    mat[1] = static_cast<float>(ys);
+    mat[2] = static_cast<float>(ys);
+    mat[3] = 0.0f;
+    mat[4] = static_cast<float>(-cscale * 2.0 * kb * (1.0 - kb) / kg);
+    mat[5] = static_cast<float>(cscale * 2.0 * (1.0 - kb));
+    mat[6] = static_cast<float>(cscale * 2.0 * (1.0 - kr));
+    mat[7] = static_cast<float>(-cscale * 2.0 * kr * (1.0 - kr) / kg);
+    mat[8] = 0.0f;
+
+    offset[0] = fullRange ? 0.0f : 16.0f / 255.0f;
+    offset[1] = 128.0f / 255.0f;
+    offset[2] = 128.0f / 255.0f;
+}
+
+/* ---- 初始化 ---- */
+bool FrameRenderer::Init()
+{
+    Destroy();
+
+    // 顶点数据 (位置 + UV)
+    float vertices[] = {
+        // 位置          // 纹理坐标
+        -1.0f, -1.0f, 0.0f,  0.0f, 1.0f,  // 左下
+         1.0f, -1.0f, 0.0f,  1.0f, 1.0f,  // 右下
+         1.0f,  1.0f, 0.0f,  1.0f, 0.0f,  // 右上
+        -1.0f,  1.0f, 0.0f,  0.0f, 0.0f   // 左上
+    };
+
+    unsigned int indices[] = {
+        0, 1, 2,  // 第一个三角形
+        2, 3, 0   // 第二个三角形
+    };
+
+    // 创建VAO, VBO, EBO
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+
+    glBindVertexArray(vao);
+
+    // 绑定并设置VBO
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    // 绑定并设置EBO
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // 位置属性
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // 纹理坐标属性
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // 解绑
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // 编译着色器
+    if (!initShaders()) return false;
+
+    // 设置纹理单元
+    glUseProgram(prog);
+    const char* samplers[] = {"tex0", "tex1", "tex2"};
+    for (int i = 0; i < 3; ++i) {
+        GLint texLoc = glGetUniformLocation(prog, samplers[i]);
+        if (texLoc != -1) {
+            glUniform1i(texLoc, i);
+        } else {
+            std::cerr << "Warning: Failed to find texture uniform " << samplers[i] << "\n";
+        }
+    }
+
+    locFormat       = glGetUniformLocation(prog, "uFormat");
+    locYuvMat       = glGetUniformLocation(prog, "uYuvMat");
+    locYuvOffset    = glGetUniformLocation(prog, "uYuvOffset");
+    locChromaOffset = glGetUniformLocation(prog, "uChromaOffset");
+    glUniform1i(locFormat, static_cast<int>(FrameFormat::RGB24));
+    return true;
+}
+
+bool FrameRenderer::initShaders()
+{
+    GLuint vertexShader = compile(GL_VERTEX_SHADER, vsrc);
+    if (!vertexShader) return false;
+
+    GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fsrc);
+    if (!fragmentShader) {
+        glDeleteShader(vertexShader);
+        return false;
+    }
+
+    // 链接着色器程序
+    prog = glCreateProgram();
+    glAttachShader(prog, vertexShader);
+    glAttachShader(prog, fragmentShader);
+    glLinkProgram(prog);
+
+    // 检查链接错误
+    GLint success;
+    glGetProgramiv(prog, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(prog, 512, nullptr, infoLog);
+        std::cerr << "Shader program linking failed:\n" << infoLog << "\n";
+        glDeleteProgram(prog);
+        prog = 0;
+    }
+
+    // 删除着色器
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return prog != 0;
+}
+
+GLuint FrameRenderer::compile(GLenum type, const char* source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    // 检查编译错误
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << (type == GL_VERTEX_SHADER ? "Vertex" : "Fragment")
+                  << " shader compilation failed:\n" << infoLog << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+void FrameRenderer::Destroy()
+{
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (ebo) glDeleteBuffers(1, &ebo);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (prog) glDeleteProgram(prog);
+    vbo = ebo = vao = prog = 0;
+}
+
+/* ---- 绘制 ---- */
+void FrameRenderer::Clear(int drawableW, int drawableH)
+{
+    glViewport(0, 0, drawableW, drawableH);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void FrameRenderer::Draw(const VideoTexture& texture, const ViewRect& rect)
+{
+    if (!texture.HasFrame() || rect.w <= 0 || rect.h <= 0) return;
+
+    glViewport(rect.x, rect.y, rect.w, rect.h);
+    glUseProgram(prog);
+    setColorUniforms(texture);
+    glBindVertexArray(vao);
+    texture.Bind();
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+}
+
+/* ---- 颜色转换参数 ---- */
+void FrameRenderer::setColorUniforms(const VideoTexture& texture)
+{
+    glUniform1i(locFormat, static_cast<int>(texture.Format()));
+    if (texture.Format() == FrameFormat::RGB24) return;
+
+    float mat[9], offset[3];
+    buildYuvMatrix(texture.Colorspace(), texture.FullRange(), texture.Height(), mat, offset);
+    glUniformMatrix3fv(locYuvMat, 1, GL_FALSE, mat);
+    glUniform3f(locYuvOffset, offset[0], offset[1], offset[2]);
+
+    // MPEG-2/H.264 默认色度样本与偶数列亮度对齐（左对齐），需要向右偏移 1/4 个色度像素
+    float dx = 0.0f, dy = 0.0f;
+    AVChromaLocation loc = texture.ChromaLoc();
+    bool leftSited = loc == AVCHROMA_LOC_LEFT ||
+                     loc == AVCHROMA_LOC_TOPLEFT ||
+                     loc == AVCHROMA_LOC_UNSPECIFIED;
+    if (leftSited && texture.ChromaW() < texture.Width()) {
+        dx = 0.25f / texture.ChromaW();
+    }
+    if (loc == AVCHROMA_LOC_TOPLEFT && texture.ChromaH() < texture.Height()) {
+        dy = 0.25f / texture.ChromaH();
+    }
+    glUniform2f(locChromaOffset, dx, dy);
+}
+
+ViewRect FrameRenderer::Letterbox(const ViewRect& area, float aspect)
+{
+    ViewRect r = area;
+    if (area.w <= 0 || area.h <= 0 || aspect <= 0.0f) return r;
+
+    r.w = area.w;
+    r.h = static_cast<int>(area.w / aspect);
+    if (r.h > area.h) {
+        r.h = area.h;
+        r.w = static_cast<int>(area.h * aspect);
+    }
+    r.x = area.x + (area.w - r.w) / 2;
+    r.y = area.y + (area.h - r.h) / 2;
+    return r;
+}
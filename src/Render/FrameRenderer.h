@@ -0,0 +1,44 @@
+#ifndef FRAMERENDERER_H
+#define FRAMERENDERER_H
+
+#include <glad/glad.h>
+#include "VideoTexture.h"
+
+// 视口内的矩形（GL 坐标，原点在左下角）
+struct ViewRect {
+    int x = 0, y = 0, w = 0, h = 0;
+};
+
+// 把 VideoTexture 画到视口矩形中的着色器程序与全屏四边形。
+// YUV -> RGB 的矩阵和色度采样位置按纹理中最近一帧的颜色参数在每次绘制时设置，
+// 同一个 FrameRenderer 可以依次绘制任意多路视频（多路画面共享一个 GL 上下文）。
+// 所有方法只能在持有 GL 上下文的线程调用
+class FrameRenderer {
+public:
+    FrameRenderer() = default;
+    ~FrameRenderer() = default; // GL 对象由 Destroy 在上下文销毁前释放
+
+    FrameRenderer(const FrameRenderer&) = delete;
+    FrameRenderer& operator=(const FrameRenderer&) = delete;
+
+    bool Init();
+    void Destroy();
+
+    // 清空整个可绘制区域
+    void Clear(int drawableW, int drawableH);
+    // 绘制一路视频；纹理尚未上传过帧时不绘制
+    void Draw(const VideoTexture& texture, const ViewRect& rect);
+
+    // 在 area 中按宽高比居中放置的最大矩形
+    static ViewRect Letterbox(const ViewRect& area, float aspect);
+
+private:
+    GLuint compile(GLenum type, const char* source);
+    bool   initShaders();
+    void   setColorUniforms(const VideoTexture& texture);
+
+    GLuint vao = 0, vbo = 0, ebo = 0, prog = 0;
+    GLint  locFormat = -1, locYuvMat = -1, locYuvOffset = -1, locChromaOffset = -1;
+};
+
+#endif
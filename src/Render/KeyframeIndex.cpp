@@ -0,0 +1,39 @@
+#include "KeyframeIndex.h"
+#include <algorithm>
+
+void KeyframeIndex::Build(AVStream* stream)
+{
+    stamps.clear();
+    int count = avformat_index_get_entries_count(stream);
+    stamps.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const AVIndexEntry* e = avformat_index_get_entry(stream, i);
+        if (e && (e->flags & AVINDEX_KEYFRAME) && e->timestamp != AV_NOPTS_VALUE) {
+            stamps.push_back(e->timestamp);
+        }
+    }
+    std::sort(stamps.begin(), stamps.end());
+    stamps.erase(std::unique(stamps.begin(), stamps.end()), stamps.end());
+}
+
+void KeyframeIndex::Add(int64_t ts)
+{
+    if (ts == AV_NOPTS_VALUE) return;
+
+    // 顺序播放时通常追加在末尾
+    if (stamps.empty() || ts > stamps.back()) {
+        stamps.push_back(ts);
+        return;
+    }
+    auto it = std::lower_bound(stamps.begin(), stamps.end(), ts);
+    if (it == stamps.end() || *it != ts) {
+        stamps.insert(it, ts);
+    }
+}
+
+int64_t KeyframeIndex::FindAtOrBefore(int64_t ts) const
+{
+    auto it = std::upper_bound(stamps.begin(), stamps.end(), ts);
+    if (it == stamps.begin()) return AV_NOPTS_VALUE;
+    return *(it - 1);
+}
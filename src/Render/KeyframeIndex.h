@@ -0,0 +1,30 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <vector>
+#include <cstdint>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// 视频流关键帧时间戳索引（流时间基），用于 seek 时直接定位到目标所在 GOP 的起点。
+// 与 AVIndexEntry::timestamp 一致按 DTS 记录（mp4/mov 的索引为 DTS），按 PTS 查找时调用方需减去重排偏移。
+// 打开文件时从 AVStream 的 index_entries 构建；对没有完整索引的容器，解复用过程中遇到的关键帧包会被补充进来。
+class KeyframeIndex {
+public:
+    void Build(AVStream* stream);
+    void Add(int64_t ts);
+    void Clear() { stamps.clear(); }
+
+    // 返回不晚于 ts 的最近关键帧时间戳，没有时返回 AV_NOPTS_VALUE
+    int64_t FindAtOrBefore(int64_t ts) const;
+
+    size_t Size() const { return stamps.size(); }
+    const std::vector<int64_t>& Stamps() const { return stamps; }
+
+private:
+    std::vector<int64_t> stamps; // 升序
+};
+
+#endif
@@ -0,0 +1,341 @@
+#include "MediaInput.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+MediaInput::~MediaInput() { Close(); }
+
+bool MediaInput::Open(const std::string& url, InputMode m, size_t readAhead, StageSamples* sink)
+{
+    Close();
+    if (m == InputMode::Default) return false;
+
+    samples = sink;
+    {
+        std::lock_guard<std::mutex> lock(statsMtx);
+        stats = {};
+    }
+
+    adviseAhead = std::max<size_t>(readAhead, 1024 * 1024);
+    capacity = adviseAhead;
+
+    bool ok = false;
+    if (m == InputMode::Mmap) {
+        ok = openMmap(url);
+        if (!ok) std::cerr << "mmap not available for " << url << ", using read-ahead\n";
+    }
+    if (!ok) ok = openReadAhead(url);
+    if (!ok) {
+        Close();
+        return false;
+    }
+
+    auto* ioBuf = static_cast<uint8_t*>(av_malloc(IO_BUFFER_SIZE));
+    if (ioBuf) {
+        ctx = avio_alloc_context(ioBuf, IO_BUFFER_SIZE, 0, this, readPacket, nullptr, seekPacket);
+    }
+    if (!ctx) {
+        av_free(ioBuf);
+        Close();
+        return false;
+    }
+    // 底层不可 seek（管道、直播流）时如实告诉解复用器
+    if (upstream && !upstream->seekable) ctx->seekable = 0;
+    return true;
+}
+
+void MediaInput::Close()
+{
+    if (fetcher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopReq = true;
+        }
+        spaceCv.notify_all();
+        dataCv.notify_all();
+        fetcher.join();
+    }
+    if (upstream) avio_closep(&upstream);
+    if (window) av_free(window);
+    window = nullptr;
+
+#ifndef _WIN32
+    if (mapped) munmap(mapped, static_cast<size_t>(fileSize));
+#endif
+    mapped = nullptr;
+
+    if (ctx) {
+        av_freep(&ctx->buffer);
+        avio_context_free(&ctx);
+    }
+
+    mode = InputMode::Default;
+    fileSize = -1;
+    mmapPos = advisedTo = 0;
+    winStart = winEnd = readPos = 0;
+    eof = false;
+    ioError = 0;
+    generation = 0;
+    stopReq = false;
+    samples = nullptr;
+}
+
+InputStats MediaInput::Stats() const
+{
+    std::lock_guard<std::mutex> lock(statsMtx);
+    return stats;
+}
+
+/* ---- AVIOContext 回调 ---- */
+int MediaInput::readPacket(void* opaque, uint8_t* buf, int size)
+{
+    auto* self = static_cast<MediaInput*>(opaque);
+    StageTimer timer;
+    int n = self->mode == InputMode::Mmap ? self->readMmap(buf, size) : self->readWindow(buf, size);
+    double us = timer.ElapsedMicros();
+
+    if (n > 0) {
+        std::lock_guard<std::mutex> lock(self->statsMtx);
+        self->stats.reads++;
+        self->stats.bytes += n;
+        self->stats.readMicros += us;
+        self->stats.maxReadMicros = std::max(self->stats.maxReadMicros, us);
+    }
+    if (self->samples && n > 0) self->samples->Add(us, n);
+    return n;
+}
+
+int64_t MediaInput::seekPacket(void* opaque, int64_t offset, int whence)
+{
+    return static_cast<MediaInput*>(opaque)->seek(offset, whence);
+}
+
+int64_t MediaInput::seek(int64_t offset, int whence)
+{
+    if (whence & AVSEEK_SIZE) return fileSize >= 0 ? fileSize : AVERROR(ENOSYS);
+    whence &= ~AVSEEK_FORCE;
+
+    int64_t target;
+    if (whence == SEEK_SET) {
+        target = offset;
+    } else if (whence == SEEK_CUR) {
+        target = (mode == InputMode::Mmap ? mmapPos : readPos) + offset;
+    } else if (whence == SEEK_END && fileSize >= 0) {
+        target = fileSize + offset;
+    } else {
+        return AVERROR(ENOSYS);
+    }
+    if (target < 0) return AVERROR(EINVAL);
+
+    {
+        std::lock_guard<std::mutex> lock(statsMtx);
+        stats.seeks++;
+    }
+
+    if (mode == InputMode::Mmap) {
+        // 跳出已提示的范围后从新位置重新提示
+        if (target > advisedTo || target + static_cast<int64_t>(adviseAhead) < advisedTo) {
+            advisedTo = target;
+        }
+        mmapPos = target;
+        return target;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (target >= winStart && target <= winEnd) {
+        // 窗口内：只移动读取位置，向前移动还能为预读腾出空间
+        readPos = target;
+        spaceCv.notify_one();
+        std::lock_guard<std::mutex> statsLock(statsMtx);
+        stats.windowSeeks++;
+        return target;
+    }
+
+    // 窗口外：清空窗口，预读线程从新位置重新开始
+    generation++;
+    winStart = winEnd = readPos = target;
+    eof = false;
+    ioError = 0;
+    spaceCv.notify_one();
+    return target;
+}
+
+/* ---- Mmap ---- */
+bool MediaInput::openMmap(const std::string& url)
+{
+#ifdef _WIN32
+    (void)url;
+    return false;
+#else
+    // 只映射本地普通文件
+    std::string path = url.compare(0, 5, "file:") == 0 ? url.substr(5) : url;
+    if (path.find("://") != std::string::npos) return false;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // 映射在 fd 关闭后仍然有效
+    if (p == MAP_FAILED) return false;
+
+    madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    mapped = static_cast<uint8_t*>(p);
+    fileSize = st.st_size;
+    mode = InputMode::Mmap;
+    return true;
+#endif
+}
+
+int MediaInput::readMmap(uint8_t* buf, int size)
+{
+#ifdef _WIN32
+    (void)buf;
+    (void)size;
+    return AVERROR(ENOSYS);
+#else
+    if (mmapPos >= fileSize) return AVERROR_EOF;
+    int n = static_cast<int>(std::min<int64_t>(size, fileSize - mmapPos));
+
+    // 读取位置进入已提示范围的后半段时提示下一段，让内核在解复用器读到之前把页面读进来
+    if (advisedTo < fileSize && mmapPos + n + static_cast<int64_t>(adviseAhead / 2) > advisedTo) {
+        static const int64_t page = sysconf(_SC_PAGESIZE);
+        int64_t from = std::max(advisedTo, mmapPos) / page * page;
+        int64_t to = std::min(fileSize, mmapPos + static_cast<int64_t>(adviseAhead));
+        madvise(mapped + from, static_cast<size_t>(to - from), MADV_WILLNEED);
+        advisedTo = to;
+    }
+
+    memcpy(buf, mapped + mmapPos, n);
+    mmapPos += n;
+    return n;
+#endif
+}
+
+/* ---- ReadAhead ---- */
+bool MediaInput::openReadAhead(const std::string& url)
+{
+    if (avio_open2(&upstream, url.c_str(), AVIO_FLAG_READ, nullptr, nullptr) < 0) {
+        std::cerr << "avio_open2 failed for " << url << "\n";
+        return false;
+    }
+    fileSize = avio_size(upstream);
+
+    window = static_cast<uint8_t*>(av_malloc(capacity));
+    if (!window) {
+        std::cerr << "Failed to allocate " << capacity << " byte read-ahead window\n";
+        return false;
+    }
+
+    mode = InputMode::ReadAhead;
+    fetcher = std::thread(&MediaInput::fetchLoop, this);
+    return true;
+}
+
+int MediaInput::readWindow(uint8_t* buf, int size)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    if (readPos == winEnd && !eof && !ioError) {
+        // 预读没跟上：解复用线程在这里等待底层 I/O
+        StageTimer stall;
+        dataCv.wait(lock, [&] { return readPos != winEnd || eof || ioError || stopReq; });
+        double us = stall.ElapsedMicros();
+        std::lock_guard<std::mutex> statsLock(statsMtx);
+        stats.stalls++;
+        stats.stallMicros += us;
+    }
+    if (readPos == winEnd) return ioError ? ioError : AVERROR_EOF;
+
+    // 一次只拷贝到环形缓冲的末尾，剩下的由下一次回调读取
+    size_t at = static_cast<size_t>(readPos % static_cast<int64_t>(capacity));
+    size_t n = std::min({static_cast<size_t>(size), static_cast<size_t>(winEnd - readPos), capacity - at});
+    lock.unlock();
+
+    memcpy(buf, window + at, n);
+
+    lock.lock();
+    readPos += static_cast<int64_t>(n);
+    lock.unlock();
+    spaceCv.notify_one();
+    return static_cast<int>(n);
+}
+
+void MediaInput::fetchLoop()
+{
+    // 每次至少凑够 chunk 的空闲空间再读，保证对底层存储是大块顺序读取
+    const size_t chunk = std::min(MAX_FETCH, capacity / 4);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopReq) {
+        uint64_t gen = generation;
+
+        // 窗口外 seek 之后，底层从新的窗口末尾继续读
+        if (avio_tell(upstream) != winEnd && !eof && !ioError) {
+            int64_t target = winEnd;
+            lock.unlock();
+            int64_t ret = avio_seek(upstream, target, SEEK_SET);
+            lock.lock();
+            if (gen != generation) continue;
+            if (ret < 0) {
+                ioError = static_cast<int>(ret);
+                dataCv.notify_all();
+            }
+            continue;
+        }
+
+        size_t space = capacity - static_cast<size_t>(winEnd - readPos);
+        if (eof || ioError || space < chunk) {
+            spaceCv.wait(lock, [&] {
+                return stopReq || gen != generation ||
+                       (!eof && !ioError && capacity - static_cast<size_t>(winEnd - readPos) >= chunk);
+            });
+            continue;
+        }
+
+        // 只覆盖 readPos 之前的数据；先收缩窗口起点，解复用线程不会 seek 进正在写入的区域
+        size_t at = static_cast<size_t>(winEnd % static_cast<int64_t>(capacity));
+        size_t n = std::min({space, MAX_FETCH, capacity - at});
+        winStart = std::max(winStart, winEnd + static_cast<int64_t>(n) - static_cast<int64_t>(capacity));
+        lock.unlock();
+
+        StageTimer timer;
+        int got = avio_read(upstream, window + at, static_cast<int>(n));
+        double us = timer.ElapsedMicros();
+
+        lock.lock();
+        if (got > 0) {
+            std::lock_guard<std::mutex> statsLock(statsMtx);
+            stats.fetches++;
+            stats.fetchBytes += got;
+            stats.fetchMicros += us;
+        }
+        // 读取期间发生了窗口外 seek：这批数据属于旧位置，丢弃
+        if (gen != generation) continue;
+
+        if (got > 0) {
+            winEnd += got;
+        } else if (got == 0 || got == AVERROR_EOF) {
+            eof = true;
+        } else {
+            ioError = got;
+        }
+        dataCv.notify_all();
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef MEDIAINPUT_H
+#define MEDIAINPUT_H
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include "PipelineTimings.h"
+#include "PlayerOptions.h"
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+// 输入 I/O 统计：解复用器看到的读取，以及后台预读线程对底层存储的读取
+struct InputStats {
+    uint64_t reads = 0;          // 读取回调次数
+    uint64_t bytes = 0;          // 交给解复用器的字节数
+    double   readMicros = 0.0;   // 读取回调总耗时
+    double   maxReadMicros = 0.0;
+    uint64_t stalls = 0;         // 预读窗口为空、读取回调需要等待底层 I/O 的次数
+    double   stallMicros = 0.0;  // 等待总时长
+    uint64_t seeks = 0;          // 解复用器的 seek 次数
+    uint64_t windowSeeks = 0;    // 其中落在预读窗口内、无需重新读取的次数
+    uint64_t fetches = 0;        // 预读线程对底层的读取次数
+    uint64_t fetchBytes = 0;
+    double   fetchMicros = 0.0;
+};
+
+// 自定义 AVIOContext 输入。Open 之后把 Context() 交给 AVFormatContext::pb（AVFMT_FLAG_CUSTOM_IO），
+// 关闭顺序：先 avformat_close_input，再 Close。读取回调只在调用 avformat_* / av_read_frame 的线程中运行。
+class MediaInput {
+public:
+    MediaInput() = default;
+    ~MediaInput();
+
+    MediaInput(const MediaInput&) = delete;
+    MediaInput& operator=(const MediaInput&) = delete;
+
+    // readAhead 为预读窗口大小（Mmap 模式下为 madvise 的提前量）；samples 非空时记录每次读取回调的耗时
+    bool Open(const std::string& url, InputMode mode, size_t readAhead, StageSamples* samples = nullptr);
+    void Close();
+
+    AVIOContext* Context() const { return ctx; }
+    InputMode    Mode() const { return mode; }
+    size_t       WindowSize() const { return mode == InputMode::Mmap ? adviseAhead : capacity; }
+    int64_t      FileSize() const { return fileSize; }
+    InputStats   Stats() const;
+
+private:
+    static constexpr int    IO_BUFFER_SIZE = 64 * 1024;        // AVIOContext 自身的缓冲
+    static constexpr size_t MAX_FETCH = 4 * 1024 * 1024;       // 预读线程单次读取上限
+
+    static int     readPacket(void* opaque, uint8_t* buf, int size);
+    static int64_t seekPacket(void* opaque, int64_t offset, int whence);
+
+    bool openMmap(const std::string& url);
+    bool openReadAhead(const std::string& url);
+    int  readMmap(uint8_t* buf, int size);
+    int  readWindow(uint8_t* buf, int size);
+    int64_t seek(int64_t offset, int whence);
+    void fetchLoop();
+
+    AVIOContext* ctx = nullptr;
+    InputMode    mode = InputMode::Default;
+    int64_t      fileSize = -1;
+    StageSamples* samples = nullptr;
+
+    // Mmap
+    uint8_t* mapped = nullptr;
+    int64_t  mmapPos = 0;
+    int64_t  advisedTo = 0;      // 已 madvise(WILLNEED) 到的位置
+    size_t   adviseAhead = 0;
+
+    // ReadAhead：window 是文件偏移 [winStart, winEnd) 的环形缓存，readPos 为解复用器的读取位置。
+    // 预读线程只覆盖 readPos 之前的数据，解复用线程在锁外拷贝 [readPos, winEnd) 是安全的
+    AVIOContext* upstream = nullptr;
+    uint8_t* window = nullptr;
+    size_t   capacity = 0;
+    int64_t  winStart = 0, winEnd = 0, readPos = 0;
+    bool     eof = false;
+    int      ioError = 0;
+    uint64_t generation = 0;     // 每次窗口外 seek 递增，预读线程据此丢弃旧位置的数据
+    bool     stopReq = false;
+    std::thread fetcher;
+    std::mutex  mtx;
+    std::condition_variable dataCv;   // 预读线程 -> 解复用线程
+    std::condition_variable spaceCv;  // 解复用线程 -> 预读线程
+
+    mutable std::mutex statsMtx;
+    InputStats stats;
+};
+
+#endif
@@ -0,0 +1,2194 @@
+#include "MediaSession.h"
+#include <iostream>
+#include <cstring>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if DEBUG_ENABLED
+#include <fstream>
+#endif
+
+/* ========== YUV 辅助 ========== */
+// 着色器可以直接处理的 8bit YUV 格式，其余格式走 sws_scale 回退路径
+static bool isShaderYuvFormat(AVPixelFormat f)
+{
+    switch (f) {
+        case AV_PIX_FMT_YUV420P:
+        case AV_PIX_FMT_YUVJ420P:
+        case AV_PIX_FMT_YUV422P:
+        case AV_PIX_FMT_YUVJ422P:
+        case AV_PIX_FMT_YUV444P:
+        case AV_PIX_FMT_YUVJ444P:
+        case AV_PIX_FMT_NV12:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool isJpegYuvFormat(AVPixelFormat f)
+{
+    return f == AV_PIX_FMT_YUVJ420P || f == AV_PIX_FMT_YUVJ422P || f == AV_PIX_FMT_YUVJ444P;
+}
+
+// 缩放时按同布局的有限范围格式处理全范围（J）格式：像素值原样缩放，范围仍由 colorRange 标记
+static AVPixelFormat scaleYuvFormat(AVPixelFormat f)
+{
+    switch (f) {
+        case AV_PIX_FMT_YUVJ420P: return AV_PIX_FMT_YUV420P;
+        case AV_PIX_FMT_YUVJ422P: return AV_PIX_FMT_YUV422P;
+        case AV_PIX_FMT_YUVJ444P: return AV_PIX_FMT_YUV444P;
+        default:                  return f;
+    }
+}
+
+// 按视口尺寸等比缩小，输出宽高取偶数。视口放得下整帧、或缩小后省下的像素不到 1/4 时保持原尺寸：
+// 这种情况下转换的开销抵不上少上传的数据
+static bool fitToViewport(int w, int h, int maxW, int maxH, int& outW, int& outH)
+{
+    if (w <= 0 || h <= 0 || maxW <= 0 || maxH <= 0 || (w <= maxW && h <= maxH)) return false;
+    double s = std::min(static_cast<double>(maxW) / w, static_cast<double>(maxH) / h);
+    if (s * s > 0.75) return false;
+    outW = std::max(2, static_cast<int>(w * s) & ~1);
+    outH = std::max(2, static_cast<int>(h * s) & ~1);
+    return true;
+}
+
+// 容器头已给出解码所需的全部参数时（视频尺寸与像素格式、音频采样率/声道/采样格式）可以跳过 find_stream_info
+static bool hasDecodeParams(const AVFormatContext* f)
+{
+    bool video = false;
+    for (unsigned i = 0; i < f->nb_streams; ++i) {
+        const AVCodecParameters* par = f->streams[i]->codecpar;
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+            if (par->width <= 0 || par->height <= 0 || par->format < 0) return false;
+            video = true;
+        } else if (par->codec_type == AVMEDIA_TYPE_AUDIO) {
+            if (par->sample_rate <= 0 || par->ch_layout.nb_channels <= 0 || par->format < 0) return false;
+        }
+    }
+    return video;
+}
+
+/* ========== 共享任务池上的切片并行 ========== */
+// 替换解码器的 execute / execute2：切片作业交给共享任务池，调用方（视频任务）也参与执行。
+// execute2 的 threadnr 取 ParallelFor 的 slot，小于 thread_count，且同一时刻不会被两个作业同时使用
+static int poolExecute(AVCodecContext* c, int (*func)(AVCodecContext*, void*), void* arg, int* ret, int count, int size)
+{
+    TaskScheduler::Instance().ParallelFor(count, c->thread_count, TaskScheduler::CurrentPriority(),
+                                          [&](int job, int) {
+        int r = func(c, static_cast<uint8_t*>(arg) + static_cast<size_t>(job) * size);
+        if (ret) ret[job] = r;
+    });
+    return 0;
+}
+
+static int poolExecute2(AVCodecContext* c, int (*func)(AVCodecContext*, void*, int, int), void* arg, int* ret, int count)
+{
+    TaskScheduler::Instance().ParallelFor(count, c->thread_count, TaskScheduler::CurrentPriority(),
+                                          [&](int job, int slot) {
+        int r = func(c, arg, job, slot);
+        if (ret) ret[job] = r;
+    });
+    return 0;
+}
+
+/* ========== 构析 ========== */
+MediaSession::MediaSession(const PlayerOptions& options) : opts(options) {}
+MediaSession::~MediaSession() { CleanUp(); }
+
+/* -------- 启动计时 -------- */
+void MediaSession::MarkStartup()
+{
+    if (startupMarked) return;
+    startupMarked = true;
+    startupAt = std::chrono::steady_clock::now();
+    startup = StartupTimings();
+}
+
+void MediaSession::MarkGlReady()
+{
+    startup.glReadyMs = sinceStartup();
+}
+
+double MediaSession::sinceStartup() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupAt).count();
+}
+
+/* -------- 输出尺寸上限 -------- */
+void MediaSession::SetDisplayLimit(int w, int h)
+{
+    displayW = std::max(0, w);
+    displayH = std::max(0, h);
+}
+
+void MediaSession::SetOutputLimit(int w, int h)
+{
+    if (!opts.adaptiveSize) return;
+    outMaxW.store(std::max(0, w));
+    outMaxH.store(std::max(0, h));
+}
+
+/* -------- OpenMediaAsync -------- */
+void MediaSession::OpenMediaAsync(const std::string& file)
+{
+    MarkStartup();
+    if (openThread.joinable()) openThread.join();
+
+    // 解复用器的打开不依赖 SDL/GL，与主线程的窗口初始化同时进行
+    openFile = file;
+    openOk = false;
+    openThread = std::thread([this, file] {
+        TRACE_THREAD_NAME("open");
+        TRACE_SCOPE("openInput");
+        openOk = openInput(file);
+    });
+}
+
+/* -------- LoadMedia -------- */
+bool MediaSession::LoadMedia(const std::string& file)
+{
+    MarkStartup();
+
+    // 后台已在打开同一个文件时等待其完成，否则在当前线程打开
+    bool opened = false;
+    if (openThread.joinable()) {
+        openThread.join();
+        if (openFile == file) {
+            opened = true;
+        } else {
+            if (fmt) avformat_close_input(&fmt);
+            input.Close();
+        }
+    }
+    if (!opened) openOk = openInput(file);
+    if (!openOk) return false;
+
+    // 打开视频流
+    if (!openVideo(fmt->streams[vIdx])) {
+        std::cerr << "Failed to open video stream\n";
+        return false;
+    }
+
+    videoPq.SetTimeBase(fmt->streams[vIdx]->time_base);
+
+    // 帧缓存只服务于交互式的 seek / 逐帧，无窗口模式不保留副本
+    frameCache.Configure(opts.headless ? 0 : opts.frameCacheMB * 1024 * 1024, opts.frameCacheScale, opts.frameCacheYuv420);
+    if (frameCache.Enabled()) {
+        std::cout << "Frame cache: " << opts.frameCacheMB << " MB, 1/" << frameCache.Scale() << " size"
+                  << (frameCache.Yuv420() ? ", 4:2:0" : "") << "\n";
+    }
+
+    // 从容器索引构建关键帧索引，seek 时直接定位到目标所在 GOP
+    keyIndex.Build(fmt->streams[vIdx]);
+    std::cout << "Keyframe index: " << keyIndex.Size() << " entries\n";
+
+    // 打开音频流（如果有）；多路画面中不出声的会话不解码音频
+    if (aIdx != -1 && opts.disableAudio) {
+        std::cout << "Audio disabled for this session\n";
+        aIdx = -1;
+    } else if (aIdx != -1) {
+        audioPq.SetTimeBase(fmt->streams[aIdx]->time_base);
+        if (!openAudio(fmt->streams[aIdx])) {
+            std::cerr << "Failed to open audio stream\n";
+            // 即使音频失败也继续，按无音频处理，避免解复用线程向无人消费的队列投递
+            aIdx = -1;
+        }
+    } else {
+        std::cout << "No audio stream found, continuing without audio\n";
+    }
+
+    // 没有可用的音频输出（无音频流、打开失败、无窗口模式）时音频主时钟退回外部时钟
+    syncMode = ResolveSyncMode(opts.syncMode, aIdx != -1 && audioDev);
+    if (syncMode != opts.syncMode) {
+        std::cout << "No audio output, falling back to " << SyncModeName(syncMode) << " clock\n";
+    }
+
+    // 分配资源
+    pkt = av_packet_alloc();
+    vf = av_frame_alloc();
+    af = av_frame_alloc();
+
+    if (!pkt || !vf || !af) {
+        std::cerr << "Failed to allocate FFmpeg resources\n";
+        return false;
+    }
+
+    startup.mediaLoadedMs = sinceStartup();
+
+    std::cout << "Media loaded successfully\n";
+    std::cout << "Video: " << vw << "x" << vh << " @ " << videoFPS << " fps\n";
+    std::cout << "Sync: " << SyncModeName(syncMode) << " master\n";
+    if (aIdx != -1) {
+        std::cout << "Audio: " << ac->sample_rate << " Hz, "
+                  << ac->ch_layout.nb_channels << " channels\n";
+    }
+
+    return true;
+}
+
+/* -------- 打开解复用器（可在后台线程执行，不触碰 SDL/GL） -------- */
+bool MediaSession::openInput(const std::string& file)
+{
+    // 重置索引
+    vIdx = -1;
+    aIdx = -1;
+    timings.Clear();
+
+    fmt = avformat_alloc_context();
+    if (!fmt) {
+        std::cerr << "Failed to allocate format context\n";
+        return false;
+    }
+
+    // 自定义输入：mmap 或后台大块预读，解复用线程的读取不再直接落到存储上
+    if (opts.inputMode != InputMode::Default) {
+        if (input.Open(file, opts.inputMode, opts.readAheadBytes,
+                       opts.collectTimings ? &timings.input : nullptr)) {
+            fmt->pb = input.Context();
+            fmt->flags |= AVFMT_FLAG_CUSTOM_IO;
+            std::cout << "Input: " << InputModeName(input.Mode()) << ", "
+                      << input.WindowSize() / (1024 * 1024) << " MB read-ahead\n";
+        } else {
+            std::cerr << "Custom input unavailable, using FFmpeg I/O\n";
+        }
+    }
+
+    // 快速启动：限制探测的数据量和时长，不为估计帧率额外解码（帧率由 av_guess_frame_rate 给出）
+    if (opts.fastStart) {
+        fmt->probesize = opts.probeSize;
+        fmt->max_analyze_duration = opts.analyzeDurationUs;
+        fmt->fps_probe_size = 0;
+    }
+
+    // 打开媒体文件
+    if (avformat_open_input(&fmt, file.c_str(), nullptr, nullptr) < 0) {
+        std::cerr << "Failed to open input file: " << file << "\n";
+        return false;
+    }
+    startup.inputOpenedMs = sinceStartup();
+
+    // 获取流信息：容器头已经足够时跳过，其余信息由解码器在播放中得到
+    startup.streamInfoSkipped = opts.fastStart && hasDecodeParams(fmt);
+    if (!startup.streamInfoSkipped && avformat_find_stream_info(fmt, nullptr) < 0) {
+        std::cerr << "Failed to find stream info\n";
+        return false;
+    }
+    startup.streamInfoMs = sinceStartup();
+
+    // 查找视频和音频流
+    for (unsigned i = 0; i < fmt->nb_streams; ++i) {
+        auto codec_type = fmt->streams[i]->codecpar->codec_type;
+        if (codec_type == AVMEDIA_TYPE_VIDEO && vIdx == -1) {
+            vIdx = i;
+        }
+        if (codec_type == AVMEDIA_TYPE_AUDIO && aIdx == -1) {
+            aIdx = i;
+        }
+    }
+
+    if (vIdx == -1) {
+        std::cerr << "No video stream found\n";
+        return false;
+    }
+    return true;
+}
+
+/* -------- Play -------- */
+void MediaSession::Play()
+{
+    if (playing && paused) {
+        paused = false;
+        auto now = std::chrono::steady_clock::now();
+        videoClock.SetPaused(false, now);
+        extClock.SetPaused(false, now);
+        if (audioDev) SDL_PauseAudioDevice(audioDev, 0); // 恢复音频
+        return;
+    }
+    if (playing) return;
+
+    playing = true;
+    paused = false;
+    stopReq = false;
+    audioReady = false;
+    videoEof = false;
+    auto now = std::chrono::steady_clock::now();
+    for (MediaClock* c : {&videoClock, &extClock}) {
+        c->SetPaused(false, now);
+        c->Invalidate();          // 由第一帧之后的帧建立
+    }
+    seekReq = false;
+    seekDisplayPending = false;
+    firstFramePending = true;
+    discardCachedFrame();
+    stepPending = false;
+    coveredPts = -1.0;
+
+    if (!opts.metricsFile.empty()) {
+        metricsExporter.Start(metrics.registry, opts.metricsFile,
+                              std::chrono::milliseconds(opts.metricsIntervalMs), [this] { sampleGauges(); });
+    }
+
+    // 启动解复用和各流的解码：专用线程，或提交到共享任务池
+    videoPq.Start();
+    audioPq.Start();
+    demuxEof = false;
+    if (opts.sharedPool) {
+        startStageTasks();
+    } else {
+        demuxThread = std::thread(&MediaSession::demuxLoop, this);
+        videoThread = std::thread(&MediaSession::videoDecodeLoop, this);
+        if (aIdx != -1) {
+            audioThread = std::thread(&MediaSession::audioDecodeLoop, this);
+        }
+    }
+
+    // 等待音频缓冲；快速启动时不等待，第一帧先显示，音频就绪后再按音频时钟推进
+    if (aIdx != -1 && !opts.fastStart) {
+        std::cout << "Buffering audio...\n";
+        while (!stopReq && !audioReady.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::cout << "Audio ready\n";
+    }
+}
+
+/* -------- Pause -------- */
+void MediaSession::Pause() {
+    if (playing && !paused) {
+        paused = true;
+        auto now = std::chrono::steady_clock::now();
+        videoClock.SetPaused(true, now);
+        extClock.SetPaused(true, now);
+        if (audioDev) SDL_PauseAudioDevice(audioDev, 1); // 暂停音频
+    }
+}
+
+/* -------- Stop -------- */
+void MediaSession::Stop()
+{
+    if (!playing) return;
+
+    stopReq = true;
+    qCv.notify_all();
+    frameProduced();
+    pcmRing.WakeWriter();
+    videoPq.Abort();
+    audioPq.Abort();
+
+    for (std::thread* t : {&demuxThread, &videoThread, &audioThread}) {
+        if (t->joinable()) t->join();
+    }
+    if (opts.sharedPool) {
+        waitStageTasks();
+        endVideoDecode();
+        if (aIdx != -1) endAudioDecode();
+    }
+
+    videoPq.Flush();
+    audioPq.Flush();
+
+    // 清空视频队列（解码线程已退出，当前线程是唯一消费者）
+    FrameData fd;
+    while (vq.TryPop(fd)) {
+        releaseFrame(fd);
+    }
+    discardCachedFrame();
+    stepPending = false;
+    coveredPts = -1.0;
+
+    // 清空音频缓冲
+    pcmRing.DiscardWritten();
+
+    playing = false;
+    paused = false;
+
+    metricsExporter.Stop();   // 写入最后一行快照
+}
+
+/* -------- Seek -------- */
+void MediaSession::Seek(double s) {
+    if (!playing || !fmt) return;
+
+    // 限制在 [开始时间, 结束时间] 内（秒，与帧 PTS 同一基准）
+    double start = (fmt->start_time != AV_NOPTS_VALUE) ? fmt->start_time / static_cast<double>(AV_TIME_BASE) : 0.0;
+    double end = (fmt->duration != AV_NOPTS_VALUE) ? start + fmt->duration / static_cast<double>(AV_TIME_BASE) : s;
+    s = std::clamp(s, start, std::max(start, end - 0.1));
+
+    std::cout << "[Seek] to " << std::fixed << std::setprecision(3) << s << " seconds\n";
+
+    // 新序号之前的帧、音频和数据包全部作废
+    seekTarget.store(s);
+    seekStart = std::chrono::steady_clock::now();
+    seekDisplayPending = true;
+    videoClock.Invalidate();   // 从 seek 后的帧重新建立
+    extClock.Invalidate();
+    playSerial.fetch_add(1);
+
+    // 先丢弃已缓冲的旧数据包再发出请求，避免冲掉解复用线程随后投递的 Flush 标记
+    videoPq.Flush();
+    audioPq.Flush();
+    seekReq.store(true);
+
+    // 丢弃环形缓冲区中的旧数据，音频时钟从目标位置重新开始
+    pcmRing.DiscardWritten();
+    pcmRing.WakeWriter();
+    audioWritePts.store(s);
+    clockPts.store(s + deviceLatency);
+    clockAt.store(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    qCv.notify_all();
+    kickStage(demuxTask);
+
+    // 帧缓存中有目标位置的帧时立即显示；流水线照常 seek，解出的同一帧被丢弃，从下一帧接上
+    discardCachedFrame();
+    stepPending = false;
+    coveredPts = -1.0;
+    if (frameCache.Enabled()) {
+        bool hit = showCachedFrame(s);
+        (hit ? metrics.cacheHits : metrics.cacheMisses).Add();
+    }
+}
+
+/* -------- 逐帧 -------- */
+void MediaSession::StepFrame(int direction)
+{
+    if (!playing || !fmt || direction == 0) return;
+    Pause();
+
+    // 连续按键时上一次命中的缓存帧可能还没显示，以它为当前位置
+    const double frameDuration = 1.0 / videoFPS;
+    double pos = hasCachedFrame ? cachedFrame.pts : currentPts.load();
+    if (direction < 0) {
+        // 后退：流水线只能从关键帧解码到上一帧，缓存命中时不必等待
+        Seek(pos - frameDuration);
+        return;
+    }
+
+    // 前进：丢弃队列中不晚于当前帧的帧；刚 seek 过、队列还没接上时先查帧缓存
+    dropStaleFrames();
+    coveredPts = std::max(coveredPts, pos);
+    dropCoveredFrames();
+    if (!vq.Peek() && frameCache.Enabled()) {
+        bool hit = showCachedFrame(pos + frameDuration);
+        (hit ? metrics.cacheHits : metrics.cacheMisses).Add();
+        if (hit) return;
+    }
+    stepPending = true;
+}
+
+/* -------- RunHeadless (无窗口消费循环) -------- */
+void MediaSession::RunHeadless(const std::function<bool(const FrameData&)>& sink)
+{
+    // 不做音画同步和纹理上传，尽可能快地取出解码帧，直到解码结束
+    TRACE_THREAD_NAME("consumer");
+    FrameData fd;
+    while (!stopReq) {
+        dropStaleFrames();
+        if (vq.TryPop(fd)) {
+            frameConsumed();
+            double waitUs = std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - fd.queuedAt).count();
+            metrics.queueWait.RecordMicros(waitUs);
+            if (opts.collectTimings) {
+                timings.queueWait.Add(waitUs);
+            }
+            if (fd.pts >= 0) currentPts.store(fd.pts);
+            if (firstFramePending.exchange(false)) {
+                startup.firstFrameShownMs = sinceStartup();
+            }
+            // 帧已出队，解码线程可以继续产出，sink 的处理与解码并行
+            bool more = !sink || sink(fd);
+            releaseFrame(fd);
+            metrics.framesShown.Add();
+            if (!more) break;
+            continue;
+        }
+
+        // 队列空时阻塞，直到解码方入队新帧、到达流末尾或停止
+        std::unique_lock<std::mutex> lock(frameMtx);
+        frameCv.wait(lock, [this] { return stopReq.load() || !vq.Empty() || videoEof.load(); });
+        if (videoEof.load() && vq.Empty()) break;
+    }
+}
+
+/* ==================== 私有实现 ==================== */
+
+/* ---- openVideo ---- */
+bool MediaSession::openVideo(AVStream* stream)
+{
+    // 查找解码器
+    const AVCodec* decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!decoder) {
+        std::cerr << "Unsupported video codec\n";
+        return false;
+    }
+
+    // 分配编解码器上下文
+    vc = avcodec_alloc_context3(decoder);
+    if (!vc) {
+        std::cerr << "Failed to allocate video codec context\n";
+        return false;
+    }
+
+    // 复制流参数到编解码器上下文
+    if (avcodec_parameters_to_context(vc, stream->codecpar) < 0) {
+        std::cerr << "Failed to copy video codec parameters\n";
+        return false;
+    }
+
+    // 解码器多线程配置：thread_count 为 0 时由 FFmpeg 按 CPU 核数决定
+    vc->thread_count = opts.decodeThreads;
+    vc->thread_type = DecodeThreadTypeFlags(opts.decodeThreadType);
+    if (opts.sharedPool) {
+        // 共享任务池只接管切片级并行；帧级多线程的线程由 FFmpeg 自己创建和调度，无法交给任务池
+        TaskScheduler::Instance().Start();
+        vc->thread_type = FF_THREAD_SLICE;
+        if (vc->thread_count == 0) vc->thread_count = TaskScheduler::Instance().WorkerCount();
+    }
+
+    // 解码输出直接分配在自己的内存池中，渲染线程按引用上传
+    decArena.Attach(vc, DECODER_ARENA_SLOTS);
+
+    // 视口的上限由渲染方给出（显示器尺寸，多路画面中为一格的最大尺寸）：支持 lowres 的解码器（MPEG-1/2/4、MJPEG 等）
+    // 直接以 1/2、1/4 尺寸解码，只取缩小后仍不小于该上限的级别。lowres 必须在打开解码器前确定，之后的视口变化由转换阶段缩放
+    lowres = 0;
+    bool displayLimited = opts.adaptiveSize && !opts.headless && displayW > 0 && displayH > 0;
+    if (displayLimited) {
+        int cw = stream->codecpar->width, ch = stream->codecpar->height;
+        if (cw > 0 && ch > 0) {
+            double s = std::min({1.0, static_cast<double>(displayW) / cw, static_cast<double>(displayH) / ch});
+            while (lowres < decoder->max_lowres && std::ldexp(1.0, -(lowres + 1)) >= s) {
+                ++lowres;
+            }
+            vc->lowres = lowres;
+        }
+    }
+
+    // 打开解码器
+    if (avcodec_open2(vc, decoder, nullptr) < 0) {
+        std::cerr << "Failed to open video codec\n";
+        return false;
+    }
+
+    // 打开时 FFmpeg 装上了自己的切片线程池，之后的切片作业改由共享任务池执行
+    bool pooled = opts.sharedPool && (vc->active_thread_type & FF_THREAD_SLICE);
+    if (pooled) {
+        vc->execute = poolExecute;
+        vc->execute2 = poolExecute2;
+    }
+
+    const char* activeMode = (vc->active_thread_type & FF_THREAD_FRAME) ? "frame"
+                           : (vc->active_thread_type & FF_THREAD_SLICE) ? "slice" : "none";
+    std::cout << "Video decoder: " << decoder->name
+              << ", threads requested " << (opts.decodeThreads ? std::to_string(opts.decodeThreads) : std::string("auto"))
+              << " (" << DecodeThreadTypeName(opts.decodeThreadType) << ")"
+              << ", active " << vc->thread_count << " (" << activeMode << (pooled ? ", shared pool" : "") << ")\n";
+
+    const char* pixFmtName = vc->pix_fmt != AV_PIX_FMT_NONE ? av_get_pix_fmt_name(vc->pix_fmt) : "unknown";
+
+    // 获取视频尺寸（已按 lowres 缩小）
+    vw = vc->width;
+    vh = vc->height;
+    if (lowres > 0) {
+        std::cout << "Decoder lowres " << lowres << ": " << stream->codecpar->width << "x"
+                  << stream->codecpar->height << " -> " << vw << "x" << vh << "\n";
+    }
+
+    // 转换阶段缩放的输出不会大于显示器上的视口
+    maxOutW = vw;
+    maxOutH = vh;
+    if (displayLimited) {
+        fitToViewport(vw, vh, displayW, displayH, maxOutW, maxOutH);
+    }
+
+    // 计算帧率：跳过 find_stream_info 时 avg_frame_rate 可能缺失，由 r_frame_rate / 编解码器帧率推测
+    AVRational frameRate = av_guess_frame_rate(fmt, stream, nullptr);
+    if (frameRate.num > 0 && frameRate.den > 0) {
+        videoFPS = av_q2d(frameRate);
+    } else {
+        videoFPS = 30.0; // 默认值
+        std::cerr << "Warning: Using default frame rate 30fps\n";
+    }
+
+    // 着色器不支持的像素格式才需要 SWSContext 转换为 RGB24；
+    // 有界探测可能在解出第一帧之前结束，此时格式未知，由第一帧决定走哪条路径
+    if (vc->pix_fmt != AV_PIX_FMT_NONE && !isShaderYuvFormat(vc->pix_fmt)) {
+        sws = sws_getContext(vw, vh, vc->pix_fmt,
+                            vw, vh, AV_PIX_FMT_RGB24,
+                            SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!sws) {
+            std::cerr << "Failed to create SwsContext\n";
+            return false;
+        }
+    }
+
+    // YUV 路径直接引用解码器输出的帧，只有 sws_scale 回退路径需要帧缓冲池
+    if (sws) {
+        int bufferSize = av_image_get_buffer_size(AV_PIX_FMT_RGB24, vw, vh, 1);
+        if (bufferSize <= 0 || !framePool.Init(bufferSize, FRAME_POOL_SLOTS)) {
+            std::cerr << "Failed to allocate video frame pool\n";
+            return false;
+        }
+    }
+
+    std::cout << "Video initialized" << (opts.headless ? " (headless)" : "") << ": " << vw << "x" << vh
+              << " (" << pixFmtName << ") @ " << videoFPS << " fps, "
+              << (sws ? "sws_scale RGB24 fallback" : "GPU YUV conversion") << "\n";
+    return true;
+}
+
+/* ---- openAudio ---- */
+bool MediaSession::openAudio(AVStream* stream)
+{
+    // 查找解码器
+    const AVCodec* decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!decoder) {
+        std::cerr << "Unsupported audio codec\n";
+        return false;
+    }
+
+    // 分配编解码器上下文
+    ac = avcodec_alloc_context3(decoder);
+    if (!ac) {
+        std::cerr << "Failed to allocate audio codec context\n";
+        return false;
+    }
+
+    // 复制流参数到编解码器上下文
+    if (avcodec_parameters_to_context(ac, stream->codecpar) < 0) {
+        std::cerr << "Failed to copy audio codec parameters\n";
+        return false;
+    }
+
+    // 打开解码器
+    if (avcodec_open2(ac, decoder, nullptr) < 0) {
+        std::cerr << "Failed to open audio codec\n";
+        return false;
+    }
+
+    // 设置SDL音频参数
+    SDL_AudioSpec desired, obtained;
+    SDL_zero(desired);
+    desired.freq = ac->sample_rate;
+    desired.format = AUDIO_S16SYS;
+    desired.channels = ac->ch_layout.nb_channels;
+    desired.samples = 2048;
+    desired.callback = audioCallback;
+    desired.userdata = this;
+
+    if (opts.headless) {
+        // 无音频设备：按源参数重采样为 S16 后直接丢弃
+        obtained = desired;
+    } else {
+        // 音频子系统按会话引用计数，最后一个会话释放时才关闭
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+            std::cerr << "SDL_InitSubSystem(AUDIO) Error: " << SDL_GetError() << "\n";
+            return false;
+        }
+        audioSubsystem = true;
+
+        // 打开音频设备：由回调拉取数据；重采样固定输出 S16，只允许采样率和声道数变化
+        audioDev = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained,
+                                       SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+        if (!audioDev) {
+            std::cerr << "SDL_OpenAudioDevice failed: " << SDL_GetError() << "\n";
+            return false;
+        }
+    }
+
+    // 计算每秒字节数
+    bytesPerSec = obtained.freq * obtained.channels * (SDL_AUDIO_BITSIZE(obtained.format) / 8);
+
+    // 创建重采样上下文
+    AVChannelLayout outLayout;
+    av_channel_layout_default(&outLayout, obtained.channels);
+
+    if (swr_alloc_set_opts2(&swr,
+                           &outLayout, AV_SAMPLE_FMT_S16, obtained.freq,
+                           &ac->ch_layout, ac->sample_fmt, ac->sample_rate,
+                           0, nullptr) < 0) {
+        std::cerr << "Failed to create SwrContext\n";
+        return false;
+    }
+
+    if (swr_init(swr) < 0) {
+        std::cerr << "Failed to initialize SwrContext\n";
+        return false;
+    }
+
+    audioOutRate = obtained.freq;
+    audioOutChannels = obtained.channels;
+
+    // 分配音频缓冲区：按一个设备缓冲起步，解码线程按每帧重采样输出的上限增长
+    int bufferSize = obtained.samples * obtained.channels * sizeof(int16_t);
+    av_fast_malloc(&audBuf, &audBufSize, bufferSize);
+    if (!audBuf) {
+        std::cerr << "Failed to allocate audio buffer\n";
+        return false;
+    }
+
+    // 解码线程与音频回调之间的 PCM 环形缓冲区，约 AUDIO_CACHE_MS 的数据量
+    size_t ringBytes = std::max<size_t>(static_cast<size_t>(bytesPerSec) * AUDIO_CACHE_MS / 1000,
+                                        static_cast<size_t>(bufferSize) * 4);
+    if (!pcmRing.Init(ringBytes, bytesPerSec)) {
+        std::cerr << "Failed to allocate PCM ring buffer\n";
+        return false;
+    }
+
+    // 设备延迟：回调填充的数据要等设备中已有的一个缓冲播完后才开始播放
+    deviceLatency = 2.0 * obtained.samples / obtained.freq;
+
+    // 启动音频设备
+    if (audioDev) SDL_PauseAudioDevice(audioDev, 0);
+
+    std::cout << "Audio initialized: " << obtained.freq << " Hz, "
+              << obtained.channels << " channels\n";
+
+    return true;
+}
+
+/* ---- 音频回调（SDL 音频线程） ---- */
+void MediaSession::audioCallback(void* userdata, Uint8* stream, int len)
+{
+    static_cast<MediaSession*>(userdata)->fillAudio(stream, len);
+}
+
+void MediaSession::fillAudio(Uint8* stream, int len)
+{
+    double endPts = -1.0;
+    size_t got = pcmRing.Read(stream, static_cast<size_t>(len), &endPts);
+
+    // 数据不足时补静音（S16 的静音为 0）
+    if (got < static_cast<size_t>(len)) {
+        memset(stream + got, 0, len - got);
+        if (audioReady.load()) metrics.audioUnderruns.Add();
+    }
+
+    // 记录本次交给设备的数据末尾对应的 PTS 和回调时刻
+    if (got > 0 && endPts >= 0) {
+        clockPts.store(endPts);
+        clockAt.store(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+}
+
+/* ---- 时钟 ---- */
+double MediaSession::getAudioClock() const
+{
+    if (aIdx == -1 || !audioDev) return 0.0;
+
+    // 已消费样本对应的 PTS 减去设备延迟，再加上距上次回调经过的时间
+    double base = clockPts.load() - deviceLatency;
+    if (paused) return base;
+
+    auto at = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(clockAt.load()));
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - at).count();
+
+    // 回调停顿（欠载、暂停恢复）时不超过已交给设备的数据
+    return base + std::clamp(elapsed, 0.0, deviceLatency);
+}
+
+/* ---- 解复用线程 ---- */
+void MediaSession::demuxLoop()
+{
+    TRACE_THREAD_NAME("demux");
+    #if DEBUG_ENABLED
+    auto lastStatusTime = std::chrono::steady_clock::now();
+    #endif
+
+    while (!stopReq) {
+        // 文件结束后保持线程存活，以便继续响应 seek
+        if (!demuxOne()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        #if DEBUG_ENABLED
+        // 定期报告队列状态
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::seconds>(now - lastStatusTime).count() >= 1) {
+            std::cout << "[STATUS] Video queue: " << vq.Size() << "/" << MAX_VQ
+                      << ", video packets: " << videoPq.Size()
+                      << " (" << std::fixed << std::setprecision(2) << videoPq.Duration() << "s)"
+                      << ", audio packets: " << audioPq.Size()
+                      << " (" << audioPq.Duration() << "s)\n";
+            lastStatusTime = now;
+        }
+        #endif
+    }
+
+    std::cout << "Demux thread exited\n";
+}
+
+// 处理 seek 请求，或读取并分发一个数据包；已到文件末尾且没有 seek 请求时返回 false。
+// 包队列满时 Put 阻塞在对应流上（任务池模式下由 demuxReadyForWork 保证两个队列都未满）
+bool MediaSession::demuxOne()
+{
+    // 处理 seek 请求
+    if (seekReq.load()) {
+        performSeek();
+        demuxEof = false;
+        return true;
+    }
+    if (demuxEof) return false;
+
+    // 读取数据包
+    StageTimer readTimer;
+    int ret;
+    {
+        TRACE_SCOPE("av_read_frame");
+        ret = av_read_frame(fmt, pkt);
+    }
+    if (ret >= 0) {
+        double readUs = readTimer.ElapsedMicros();
+        metrics.demux.RecordMicros(readUs);
+        if (opts.collectTimings) timings.demux.Add(readUs, pkt->size);
+    }
+    if (ret < 0) {
+        if (ret == AVERROR_EOF) {
+            std::cout << "End of file reached\n";
+        } else {
+            char errbuf[256];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            std::cerr << "av_read_frame error: " << errbuf << "\n";
+        }
+
+        // 通知各解码线程冲刷解码器
+        videoPq.PutEof();
+        if (aIdx != -1) audioPq.PutEof();
+        demuxEof = true;
+        kickStage(videoTask);
+        kickStage(audioTask);
+        return true;
+    }
+
+    // 按流分发；队列满时只阻塞在对应流上
+    if (pkt->stream_index == vIdx) {
+        // 容器索引不完整时，播放过程中补充关键帧索引（与容器索引同为 DTS），并记录关键帧的重排偏移
+        if ((pkt->flags & AV_PKT_FLAG_KEY) && pkt->dts != AV_NOPTS_VALUE) {
+            keyIndex.Add(pkt->dts);
+            if (pkt->pts != AV_NOPTS_VALUE) keyPtsDelay = std::max(keyPtsDelay, pkt->pts - pkt->dts);
+        }
+        videoPq.Put(pkt);
+        kickStage(videoTask);
+    } else if (aIdx != -1 && pkt->stream_index == aIdx) {
+        audioPq.Put(pkt);
+        kickStage(audioTask);
+    }
+    av_packet_unref(pkt);
+    return true;
+}
+
+/* ---- 执行 seek（解复用线程） ---- */
+void MediaSession::performSeek()
+{
+    TRACE_SCOPE("performSeek");
+    // 先清除请求标志：执行期间到来的新请求留到下一轮处理
+    seekReq.store(false);
+    int serial = playSerial.load();
+    double target = seekTarget.load();
+
+    AVStream* vs = fmt->streams[vIdx];
+    int64_t streamTs = static_cast<int64_t>(target / av_q2d(vs->time_base));
+    // 索引是 DTS，目标是 PTS：按最大重排偏移提前查找，保证选中关键帧的显示时间不晚于目标。
+    // 还没读到过关键帧（偏移未知）时交给 avformat_seek_file 按目标时间定位
+    int64_t keyTs = keyPtsDelay >= 0 ? keyIndex.FindAtOrBefore(streamTs - keyPtsDelay) : AV_NOPTS_VALUE;
+
+    int ret;
+    if (keyTs != AV_NOPTS_VALUE) {
+        // 索引命中：直接跳到目标所在 GOP 的关键帧
+        ret = av_seek_frame(fmt, vIdx, keyTs, AVSEEK_FLAG_BACKWARD);
+    } else {
+        int64_t us = static_cast<int64_t>(target * AV_TIME_BASE);
+        ret = avformat_seek_file(fmt, -1, INT64_MIN, us, us, 0);
+    }
+    if (ret < 0) {
+        char errbuf[256];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        std::cerr << "Seek to " << target << "s failed: " << errbuf << "\n";
+    }
+
+    // 丢弃 seek 之前读到的数据包，并通知解码线程冲刷解码器
+    videoPq.Flush();
+    audioPq.Flush();
+    videoPq.PutFlush(serial);
+    if (aIdx != -1) audioPq.PutFlush(serial);
+    kickStage(videoTask);
+    kickStage(audioTask);
+
+    #if DEBUG_ENABLED
+    if (debugOutput) {
+        std::ostringstream oss;
+        oss << "Seek to " << std::fixed << std::setprecision(3) << target << "s, keyframe ";
+        if (keyTs != AV_NOPTS_VALUE) oss << keyTs * av_q2d(vs->time_base) << "s";
+        else oss << "unknown";
+        oss << " (index " << keyIndex.Size() << " entries)";
+        logDebug(oss.str());
+    }
+    #endif
+}
+
+/* ---- 视频解码线程 ---- */
+void MediaSession::videoDecodeLoop()
+{
+    TRACE_THREAD_NAME("video-decode");
+    beginVideoDecode();
+
+    while (!stopReq) {
+        int serial = 0;
+        PacketQueue::Item item = videoPq.Get(vdec.pkt, &serial);
+        if (item == PacketQueue::Item::Aborted) break;
+        decodeVideoItem(item, serial);
+    }
+
+    endVideoDecode();
+    std::cout << "Video decoding thread exited\n";
+}
+
+void MediaSession::beginVideoDecode()
+{
+    vdec = VideoDecodeState();
+    videoParked = false;
+    vdec.pkt = av_packet_alloc();
+    videoDecSerial = playSerial.load();
+}
+
+void MediaSession::endVideoDecode()
+{
+    if (videoParked.exchange(false)) releaseFrame(vdec.parked);
+    av_packet_free(&vdec.pkt);
+    videoEof = true;
+    frameProduced();
+}
+
+// 处理视频包队列中的一个元素：seek 冲刷标记、流结束或数据包
+void MediaSession::decodeVideoItem(PacketQueue::Item item, int serial)
+{
+    AVPacket* vpkt = vdec.pkt;
+
+    if (item == PacketQueue::Item::Flush) {
+        // seek：丢弃解码器内部的参考帧，从新的关键帧开始解码
+        avcodec_flush_buffers(vc);
+        videoDecSerial = serial;
+        vdec.skipUntil = seekTarget.load();
+        videoEof = false;
+        // seek 精确定位的目标帧可能是非参考帧，恢复正常解码
+        vdec.lateRun = vdec.windowFrames = vdec.windowLate = 0;
+        vc->skip_frame = AVDISCARD_DEFAULT;
+        return;
+    }
+
+    if (item == PacketQueue::Item::Eof) {
+        // 刷新视频解码器
+        avcodec_send_packet(vc, nullptr);
+        vdec.draining = true;
+        drainVideoDecoder();
+        return;
+    }
+
+    // 发送数据包到解码器（解码耗时不含帧处理）
+    StageTimer decodeTimer;
+    double decodeMicros = 0.0;
+    int pktBytes = vpkt->size;
+    int ret;
+    {
+        TRACE_SCOPE("avcodec_send_packet");
+        ret = avcodec_send_packet(vc, vpkt);
+    }
+    av_packet_unref(vpkt);
+    if (ret < 0) {
+        std::cerr << "Failed to send video packet to decoder\n";
+        return;
+    }
+    decodeMicros += decodeTimer.ElapsedMicros();
+
+    // 接收解码后的帧
+    decodeMicros += receiveVideoFrames();
+
+    metrics.videoDecode.RecordMicros(decodeMicros);
+    if (opts.collectTimings) {
+        timings.videoDecode.Add(decodeMicros, pktBytes);
+    }
+}
+
+// 取出解码器对已送入数据包的输出：seek 精确定位、迟到丢弃、过载检测后送入帧队列，返回接收耗时（微秒）。
+// 任务池模式下帧队列满时帧被挂起，剩余输出留在解码器中（receivePending），由 resumeVideoOutput 继续
+double MediaSession::receiveVideoFrames()
+{
+    const double halfFrame = 0.5 / videoFPS;
+    const double frameDuration = 1.0 / videoFPS;
+    const int overloadWindow = std::max(8, static_cast<int>(videoFPS * 2));   // 约 2 秒的帧
+    double decodeMicros = 0.0;
+    int ret;
+    vdec.receivePending = false;
+
+    while (!stopReq) {
+        StageTimer recvTimer;
+        {
+            TRACE_SCOPE("avcodec_receive_frame");
+            ret = avcodec_receive_frame(vc, vf);
+        }
+        decodeMicros += recvTimer.ElapsedMicros();
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        } else if (ret < 0) {
+            std::cerr << "Video decoding error\n";
+            break;
+        }
+
+        // seek 之后从关键帧解码到目标 PTS，之前的帧不做转换也不入队
+        if (vdec.skipUntil >= 0.0) {
+            int64_t ts = vf->best_effort_timestamp;
+            if (ts != AV_NOPTS_VALUE &&
+                ts * av_q2d(fmt->streams[vIdx]->time_base) < vdec.skipUntil - halfFrame) {
+                // 从关键帧到目标之间的帧不显示，但留在帧缓存中：之后逐帧后退时直接命中
+                cacheFrame(vf);
+                av_frame_unref(vf);
+                continue;
+            }
+            vdec.skipUntil = -1.0;
+        }
+
+        // 显示时刻已过一帧以上的帧会被后面的帧取代：不做转换直接丢弃。
+        // 连续丢弃有上限，解码持续跟不上时仍按一定间隔送显，画面不会停住
+        bool late = decodeLateness(framePts(vf)) > frameDuration;
+        if (late && vdec.lateRun < MAX_LATE_DROPS) {
+            vdec.lateRun++;
+            metrics.lateDecodeDrops.Add();
+        } else {
+            if (late) metrics.lateKept.Add();
+            vdec.lateRun = 0;
+            // 处理视频帧：引用转移给队列，vf 被置空
+            processVideoFrame(vf);
+        }
+        av_frame_unref(vf);
+
+        // 持续过载：窗口内半数以上的帧迟到时让解码器跳过非参考帧，整个窗口都准时后恢复
+        vdec.windowLate += late ? 1 : 0;
+        if (++vdec.windowFrames >= overloadWindow) {
+            if (vdec.windowLate * 2 >= vdec.windowFrames && vc->skip_frame < AVDISCARD_NONREF) {
+                vc->skip_frame = AVDISCARD_NONREF;
+                std::cout << "[Drop] decoder overloaded (" << vdec.windowLate << "/" << vdec.windowFrames
+                          << " frames late), skipping non-reference frames\n";
+                metrics.nonrefEnter.Add();
+            } else if (vdec.windowLate == 0 && vc->skip_frame != AVDISCARD_DEFAULT) {
+                vc->skip_frame = AVDISCARD_DEFAULT;
+                std::cout << "[Drop] decoder caught up, decoding all frames\n";
+                metrics.nonrefExit.Add();
+            }
+            vdec.windowFrames = vdec.windowLate = 0;
+        }
+        if (videoParked.load()) break;
+    }
+    vdec.receivePending = videoParked.load();
+    return decodeMicros;
+}
+
+// 流结束时取出解码器中剩余的帧；任务池模式下帧队列满时中途返回（draining 保持），腾出空间后继续
+void MediaSession::drainVideoDecoder()
+{
+    while (!stopReq && !videoParked.load() && avcodec_receive_frame(vc, vf) >= 0) {
+        processVideoFrame(vf);
+    }
+    if (videoParked.load()) return;
+    // 冲刷后需要重置解码器，之后还可能 seek 回来继续解码
+    avcodec_flush_buffers(vc);
+    vdec.draining = false;
+    videoEof = true;
+    frameProduced();
+}
+
+// 任务池模式：先送出挂起的帧，再取完解码器中剩余的输出。返回 false 表示帧队列仍满，本次任务结束，
+// 由 frameConsumed 重新提交
+bool MediaSession::resumeVideoOutput()
+{
+    if (videoParked.load()) {
+        if (vdec.parked.serial != playSerial.load()) {
+            releaseFrame(vdec.parked);   // seek 之前的帧，渲染方也会丢弃
+        } else if (!vq.TryPush(vdec.parked)) {
+            return false;
+        } else {
+            frameProduced();
+        }
+        vdec.parked = FrameData();
+        videoParked = false;
+    }
+    if (videoDecSerial != playSerial.load()) {
+        // 已经 seek：解码器中剩余的输出作废，包队列中随后的 Flush 标记会冲刷解码器
+        vdec.receivePending = vdec.draining = false;
+        return true;
+    }
+    if (vdec.draining) {
+        drainVideoDecoder();
+    } else if (vdec.receivePending) {
+        metrics.videoDecode.RecordMicros(receiveVideoFrames());
+    }
+    return !videoParked.load();
+}
+
+/* ---- 音频解码线程 ---- */
+void MediaSession::audioDecodeLoop()
+{
+    TRACE_THREAD_NAME("audio-decode");
+    beginAudioDecode();
+
+    while (!stopReq) {
+        int serial = 0;
+        PacketQueue::Item item = audioPq.Get(adec.pkt, &serial);
+        if (item == PacketQueue::Item::Aborted) break;
+        decodeAudioItem(item, serial);
+    }
+
+    endAudioDecode();
+    std::cout << "Audio decoding thread exited\n";
+}
+
+void MediaSession::beginAudioDecode()
+{
+    adec = AudioDecodeState();
+    adec.pkt = av_packet_alloc();
+    adec.serial = playSerial.load();
+}
+
+void MediaSession::endAudioDecode()
+{
+    // 音频流过短时也要解除 Play() 的等待
+    audioReady.store(true);
+    av_packet_free(&adec.pkt);
+}
+
+// 处理音频包队列中的一个元素：解码、重采样后写入 PCM 环形缓冲区
+void MediaSession::decodeAudioItem(PacketQueue::Item item, int serial)
+{
+    const int bytesPerFrame = audioOutChannels * static_cast<int>(sizeof(int16_t));
+    AVPacket* apkt = adec.pkt;
+
+    if (item == PacketQueue::Item::Flush) {
+        avcodec_flush_buffers(ac);
+        adec.serial = serial;
+        adec.skipUntil = seekTarget.load();
+        adec.drift.Reset();
+        // 等待期间写入的旧数据也一并丢弃
+        pcmRing.DiscardWritten();
+        return;
+    }
+
+    // 流结束时发送空包冲刷解码器
+    bool eof = item == PacketQueue::Item::Eof;
+    StageTimer decodeTimer;
+    double decodeMicros = 0.0;
+    int pktBytes = eof ? 0 : apkt->size;
+    int ret;
+    {
+        TRACE_SCOPE("avcodec_send_packet(audio)");
+        ret = avcodec_send_packet(ac, eof ? nullptr : apkt);
+    }
+    av_packet_unref(apkt);
+    if (ret < 0) {
+        std::cerr << "Failed to send audio packet to decoder\n";
+        return;
+    }
+
+    // 接收解码后的帧
+    while (!stopReq) {
+        decodeTimer = StageTimer();
+        {
+            TRACE_SCOPE("avcodec_receive_frame(audio)");
+            ret = avcodec_receive_frame(ac, af);
+        }
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        } else if (ret < 0) {
+            std::cerr << "Audio decoding error\n";
+            break;
+        }
+
+        // 音频跟随视频/外部时钟：平均偏差超过阈值时让重采样器轻微变速，不丢视频帧
+        int wanted = af->nb_samples;
+        if (syncMode != SyncMode::Audio && audioDev && audioReady.load()) {
+            double master = masterClock(std::chrono::steady_clock::now());
+            if (!std::isnan(master)) {
+                wanted = adec.drift.WantedSamples(af->nb_samples, getAudioClock() - master, ac->sample_rate);
+            }
+            if (wanted != af->nb_samples) {
+                if (swr_set_compensation(swr,
+                                         static_cast<int>(int64_t(wanted - af->nb_samples) * audioOutRate / ac->sample_rate),
+                                         static_cast<int>(int64_t(wanted) * audioOutRate / ac->sample_rate)) < 0) {
+                    wanted = af->nb_samples;
+                } else {
+                    metrics.driftCorrections.Add();
+                }
+            }
+        }
+
+        // 重采样：输出容量按采样率换算和变速后的样本数预留，避免残留样本积压在重采样器内部
+        int outCapacity = std::max(swr_get_out_samples(swr, af->nb_samples),
+                                   static_cast<int>(int64_t(wanted) * audioOutRate / ac->sample_rate)) + 256;
+        av_fast_malloc(&audBuf, &audBufSize, static_cast<size_t>(outCapacity) * bytesPerFrame);
+        if (!audBuf) {
+            std::cerr << "Failed to grow audio buffer\n";
+            av_frame_unref(af);
+            break;
+        }
+        int outSamples;
+        {
+            TRACE_SCOPE("swr_convert");
+            outSamples = swr_convert(swr, &audBuf, outCapacity,
+                                     (const uint8_t**)af->extended_data, af->nb_samples);
+        }
+        if (outSamples < 0) {
+            std::cerr << "Audio resampling error\n";
+            av_frame_unref(af);
+            continue;
+        }
+
+        double pts = (af->pts != AV_NOPTS_VALUE) ?
+                    af->pts * av_q2d(fmt->streams[aIdx]->time_base) :
+                    audioWritePts.load();
+
+        // seek 之后丢弃目标位置之前的样本，跨越目标的帧只保留目标之后的部分
+        const uint8_t* outData = audBuf;
+        if (adec.skipUntil >= 0.0) {
+            int skipSamples = static_cast<int>((adec.skipUntil - pts) * audioOutRate);
+            if (skipSamples >= outSamples) {
+                av_frame_unref(af);
+                continue;
+            }
+            if (skipSamples > 0) {
+                outData += skipSamples * bytesPerFrame;
+                outSamples -= skipSamples;
+                pts = adec.skipUntil;
+            }
+            adec.skipUntil = -1.0;
+        }
+
+        // 计算输出大小
+        int outBytes = outSamples * bytesPerFrame;
+        decodeMicros += decodeTimer.ElapsedMicros();
+
+        // 环形缓冲区满时等待回调消费：只阻塞音频解码线程，不影响视频解码
+        // （任务池模式下音频任务只在留有余量时取包，一般不会在这里等待）
+        while (audioDev && !stopReq && adec.serial == playSerial.load() &&
+               !pcmRing.WaitForSpace(outBytes, std::chrono::milliseconds(50))) {
+        }
+
+        if (stopReq) break;
+
+        // 等待期间发生了 seek：旧位置的数据不再送入设备
+        if (adec.serial != playSerial.load()) {
+            av_frame_unref(af);
+            continue;
+        }
+
+        // 写入环形缓冲区（无窗口模式下直接丢弃）
+        if (audioDev) {
+            pcmRing.Mark(pts);
+            pcmRing.Write(outData, outBytes);
+        }
+
+        // 更新音频时钟
+        audioWritePts.store(pts + (outSamples / static_cast<double>(audioOutRate)));
+
+        // 标记音频准备好
+        if (++adec.frames > 10) {
+            audioReady.store(true);
+        }
+
+        av_frame_unref(af);
+    }
+
+    metrics.audioDecode.RecordMicros(decodeMicros);
+    if (opts.collectTimings) {
+        timings.audioDecode.Add(decodeMicros, pktBytes);
+    }
+
+    if (eof) {
+        // 冲刷后重置解码器，之后还可能 seek 回来继续解码；音频流过短时也要解除 Play() 的等待
+        avcodec_flush_buffers(ac);
+        audioReady.store(true);
+    }
+}
+
+/* ==================== 共享任务池模式 ==================== */
+// 解复用、视频解码、音频解码各是一个可重复提交的任务：一次处理一批数据后重新排队，
+// 无法推进时结束，由上下游在投递数据或腾出空间后唤醒。同一阶段的任务不会并发执行，
+// 解码状态与线程模式共用（vdec / adec）
+
+void MediaSession::startStageTasks()
+{
+    demuxTask.priority = opts.taskPriority;
+    videoTask.priority = opts.taskPriority;
+    audioTask.priority = TaskPriority::High;   // 音频欠载听得见，总是先于画面
+    std::cout << "Pipeline: shared task pool, " << TaskPriorityName(opts.taskPriority) << " priority\n";
+    beginVideoDecode();
+    if (aIdx != -1) beginAudioDecode();
+    kickStage(demuxTask);
+}
+
+void MediaSession::waitStageTasks()
+{
+    std::unique_lock<std::mutex> lock(taskMtx);
+    taskCv.wait(lock, [this] { return tasksInFlight == 0; });
+}
+
+// 阶段可以推进且没有任务在排队或执行时提交一个。唤醒方都在状态变化之后调用：
+// 要么看到 scheduled 为 false 自己提交，要么正在执行的任务挂起时的复查会看到新状态
+void MediaSession::kickStage(StageTask& stage)
+{
+    if (!opts.sharedPool || stopReq || !(this->*stage.ready)()) return;
+    if (stage.scheduled.exchange(true)) return;
+    submitStage(stage);
+}
+
+void MediaSession::submitStage(StageTask& stage)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMtx);
+        ++tasksInFlight;
+    }
+    TaskScheduler::Instance().Submit([this, &stage] { runStage(stage); }, stage.priority);
+}
+
+void MediaSession::runStage(StageTask& stage)
+{
+    if (!stopReq && (this->*stage.step)() && !stopReq) {
+        // 这一批处理完仍有工作：重新排队，先让其他会话的任务执行
+        submitStage(stage);
+    } else {
+        // 挂起后复查：挂起前到来的唤醒因 scheduled 仍为 true 而被忽略
+        stage.scheduled.exchange(false);
+        kickStage(stage);
+    }
+
+    // 这是任务对会话的最后一次访问：Stop 要等 tasksInFlight 归零才能继续
+    std::lock_guard<std::mutex> lock(taskMtx);
+    if (--tasksInFlight == 0) taskCv.notify_all();
+}
+
+bool MediaSession::demuxTaskStep()
+{
+    TRACE_SCOPE("demuxTask");
+    for (int i = 0; i < DEMUX_TASK_PACKETS; ++i) {
+        if (stopReq || !demuxReadyForWork()) return false;
+        demuxOne();
+    }
+    return true;
+}
+
+// 有 seek 请求，或未到文件末尾且两个包队列都未满：Put 不会阻塞工作线程
+bool MediaSession::demuxReadyForWork()
+{
+    if (seekReq.load()) return true;
+    return !demuxEof && !videoPq.Full() && (aIdx == -1 || !audioPq.Full());
+}
+
+bool MediaSession::videoTaskStep()
+{
+    TRACE_SCOPE("videoTask");
+    if (!resumeVideoOutput()) return false;
+    for (int i = 0; i < VIDEO_TASK_PACKETS; ++i) {
+        if (stopReq || vq.Size() >= MAX_VQ) return false;
+        int serial = 0;
+        PacketQueue::Item item = videoPq.TryGet(vdec.pkt, &serial);
+        if (item == PacketQueue::Item::Empty || item == PacketQueue::Item::Aborted) return false;
+        kickStage(demuxTask);   // 包队列腾出了空间
+        decodeVideoItem(item, serial);
+        if (videoParked.load()) return false;   // 一个包解出多帧时帧队列满了
+    }
+    return true;
+}
+
+// 帧队列满时等渲染方取帧（frameConsumed）再继续，不占用工作线程；
+// 有挂起的帧时即使包队列为空也要继续（解码器中未取完的输出只在有帧挂起时存在）
+bool MediaSession::videoReadyForWork()
+{
+    if (vq.Size() >= MAX_VQ) return false;
+    return videoPq.Size() > 0 || videoParked.load();
+}
+
+bool MediaSession::audioTaskStep()
+{
+    TRACE_SCOPE("audioTask");
+    for (int i = 0; i < AUDIO_TASK_PACKETS; ++i) {
+        if (stopReq || !audioHasSpace()) return false;
+        int serial = 0;
+        PacketQueue::Item item = audioPq.TryGet(adec.pkt, &serial);
+        if (item == PacketQueue::Item::Empty || item == PacketQueue::Item::Aborted) return false;
+        kickStage(demuxTask);
+        decodeAudioItem(item, serial);
+    }
+    return true;
+}
+
+bool MediaSession::audioReadyForWork()
+{
+    return aIdx != -1 && audioHasSpace() && audioPq.Size() > 0;
+}
+
+// 没有音频设备时输出直接丢弃；否则 PCM 缓冲区至少空出 1/4 才解码下一批
+bool MediaSession::audioHasSpace() const
+{
+    return !audioDev || pcmRing.Buffered() + pcmRing.Capacity() / 4 <= pcmRing.Capacity();
+}
+
+// 渲染方取走一帧：唤醒等待队列空间的解码线程，或帧队列满时挂起的视频任务
+void MediaSession::frameConsumed()
+{
+    qCv.notify_one();
+    kickStage(videoTask);
+}
+
+// 帧入队或视频到达流末尾：唤醒阻塞在 RunHeadless 中的消费方。
+// 先经过 frameMtx 再通知，避免消费方检查完条件、尚未进入等待时丢失唤醒
+void MediaSession::frameProduced()
+{
+    { std::lock_guard<std::mutex> lock(frameMtx); }
+    frameCv.notify_one();
+}
+
+/* ---- 帧时间与迟到程度 ---- */
+double MediaSession::framePts(const AVFrame* frame) const
+{
+    if (frame->pts != AV_NOPTS_VALUE) {
+        return frame->pts * av_q2d(fmt->streams[vIdx]->time_base);
+    }
+    if (frame->pkt_dts != AV_NOPTS_VALUE) {
+        return frame->pkt_dts * av_q2d(fmt->streams[vIdx]->time_base);
+    }
+    return -1.0;
+}
+
+// 解码线程估计帧相对主时钟迟到多少秒（正值为迟到）。
+// 外部时钟尚未建立时用最近显示帧的 PTS，早于它的帧不可能再显示；Video 主时钟等待视频，帧不会迟到。
+// 无窗口模式、暂停、seek 首帧未显示、音频尚未就绪时不判定迟到
+double MediaSession::decodeLateness(double pts) const
+{
+    if (opts.headless || pts < 0 || paused || seekDisplayPending) return 0.0;
+    switch (syncMode) {
+        case SyncMode::Audio:
+            return audioReady.load() ? getAudioClock() - pts : 0.0;
+        case SyncMode::Video:
+            return 0.0;
+        default: {
+            double master = extClock.Get(std::chrono::steady_clock::now());
+            return (std::isnan(master) ? currentPts.load() : master) - pts;
+        }
+    }
+}
+
+/* ---- 处理视频帧 ---- */
+void MediaSession::processVideoFrame(AVFrame* frame)
+{
+    if (!frame) return;
+    TRACE_SCOPE("processVideoFrame");
+    cacheFrame(frame);
+
+    // 准备帧数据：支持的 YUV 格式直接引用解码器输出的平面，其余格式转换为 RGB24
+    StageTimer convertTimer;
+    FrameData fd;
+    fd.pts = framePts(frame);
+
+    // 窗口小于视频时在转换阶段缩小到视口尺寸，少转换、少上传看不到的像素
+    int maxW = outMaxW.load(), maxH = outMaxH.load();
+    int outW = 0, outH = 0;
+    int copiedBytes = 0;
+    bool ok;
+    if (isShaderYuvFormat(static_cast<AVPixelFormat>(frame->format))) {
+        if (fitToViewport(frame->width, frame->height, maxW, maxH, outW, outH)) {
+            ok = scaleYuvFrame(frame, fd, outW, outH);
+            copiedBytes = fd.linesize[0] * fd.height + (fd.linesize[1] + fd.linesize[2]) * fd.chromaH;
+        } else {
+            ok = refYuvFrame(frame, fd);
+        }
+    } else {
+        if (!fitToViewport(vw, vh, maxW, maxH, outW, outH)) {
+            outW = vw;
+            outH = vh;
+        }
+        ok = convertRgbFrame(frame, fd, outW, outH);
+        copiedBytes = fd.width * fd.height * 3;
+    }
+
+    // 未标注色彩空间时着色器按高度猜测，缩小（含 lowres）后要按原始高度猜测
+    int sourceH = fmt->streams[vIdx]->codecpar->height;
+    if (ok && fd.format != FrameFormat::RGB24 && fd.colorspace == AVCOL_SPC_UNSPECIFIED && fd.height != sourceH) {
+        fd.colorspace = sourceH >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+    }
+    av_frame_unref(frame);
+    if (!ok) return;
+
+    double convertUs = convertTimer.ElapsedMicros();
+    metrics.convert.RecordMicros(convertUs);
+    if (opts.collectTimings) {
+        timings.convert.Add(convertUs, copiedBytes);
+    }
+
+    if (startup.firstFrameQueuedMs == 0.0) {
+        startup.firstFrameQueuedMs = sinceStartup();
+    }
+
+    // 将帧加入队列：单生产者不能弹出队首，队列满时等待渲染线程消费
+    fd.serial = videoDecSerial;
+    fd.queuedAt = std::chrono::steady_clock::now();
+    if (!vq.TryPush(fd)) {
+        if (opts.sharedPool) {
+            // 任务池模式不在工作线程上等待：挂起这一帧，调用方结束本次任务，渲染方取帧后重新提交
+            vdec.parked = fd;
+            videoParked = true;
+            return;
+        }
+        std::unique_lock<std::mutex> lock(qMtx);
+        while (!stopReq && !vq.TryPush(fd)) {
+            qCv.wait_for(lock, std::chrono::milliseconds(2));
+        }
+        if (stopReq) {
+            metrics.stopDrops.Add();
+            releaseFrame(fd);
+            return;
+        }
+    }
+    frameProduced();
+}
+
+/* ---- YUV 平面引用（GPU 转换路径） ---- */
+bool MediaSession::refYuvFrame(AVFrame* frame, FrameData& fd)
+{
+    auto pixFmt = static_cast<AVPixelFormat>(frame->format);
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(pixFmt);
+    if (!desc) return false;
+
+    // 纹理上传按正向行宽读取平面
+    int planeCount = (pixFmt == AV_PIX_FMT_NV12) ? 2 : 3;
+    for (int i = 0; i < planeCount; ++i) {
+        if (!frame->data[i] || frame->linesize[i] <= 0) return false;
+    }
+
+    fd.width  = frame->width;
+    fd.height = frame->height;
+    fd.format = (pixFmt == AV_PIX_FMT_NV12) ? FrameFormat::NV12 : FrameFormat::YUVPlanar;
+    fd.chromaW = -((-frame->width)  >> desc->log2_chroma_w);
+    fd.chromaH = -((-frame->height) >> desc->log2_chroma_h);
+    fd.colorspace = frame->colorspace;
+    fd.colorRange = isJpegYuvFormat(pixFmt) ? AVCOL_RANGE_JPEG : frame->color_range;
+    fd.chromaLoc  = frame->chroma_location;
+
+    // 不拷贝像素：转移解码器缓冲的引用，渲染线程上传后释放
+    fd.frame = acquireFrameShell();
+    if (!fd.frame) {
+        std::cerr << "Failed to allocate frame reference\n";
+        return false;
+    }
+    av_frame_move_ref(fd.frame, frame);
+
+    for (int i = 0; i < 3; ++i) {
+        fd.planes[i] = i < planeCount ? fd.frame->data[i] : nullptr;
+        fd.linesize[i] = i < planeCount ? fd.frame->linesize[i] : 0;
+    }
+    return true;
+}
+
+/* ---- 按视口缩小的 YUV 路径 ---- */
+bool MediaSession::scaleYuvFrame(const AVFrame* frame, FrameData& fd, int outW, int outH)
+{
+    // 输出保持源的平面布局，着色器照常做颜色转换
+    AVPixelFormat pixFmt = scaleYuvFormat(static_cast<AVPixelFormat>(frame->format));
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(pixFmt);
+    if (!desc) return false;
+
+    scaleSws = sws_getCachedContext(scaleSws, frame->width, frame->height, pixFmt,
+                                    outW, outH, pixFmt,
+                                    SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!scaleSws) {
+        std::cerr << "Failed to create SwsContext for scaling "
+                  << av_get_pix_fmt_name(pixFmt) << " to " << outW << "x" << outH << "\n";
+        return false;
+    }
+
+    // 帧缓冲池在第一次缩小时按显示器上的最大视口分配，之后窗口怎么变都不再分配
+    int align = static_cast<int>(FramePool::ALIGN);
+    int size = av_image_get_buffer_size(pixFmt, outW, outH, align);
+    if (size <= 0) return false;
+    if (framePool.SlotSize() == 0) {
+        int maxSize = av_image_get_buffer_size(pixFmt, maxOutW, maxOutH, align);
+        if (!framePool.Init(std::max(size, maxSize), FRAME_POOL_SLOTS)) {
+            std::cerr << "Failed to allocate scaled frame pool\n";
+            return false;
+        }
+    }
+
+    fd.data = acquireFrameBuffer(static_cast<size_t>(size));
+    if (!fd.data) return false;
+
+    uint8_t* dst[4] = {nullptr, nullptr, nullptr, nullptr};
+    int dstStride[4] = {0, 0, 0, 0};
+    av_image_fill_arrays(dst, dstStride, fd.data, pixFmt, outW, outH, align);
+    {
+        TRACE_SCOPE("sws_scale(yuv)");
+        sws_scale(scaleSws, frame->data, frame->linesize, 0, frame->height, dst, dstStride);
+    }
+
+    fd.width  = outW;
+    fd.height = outH;
+    fd.format = (pixFmt == AV_PIX_FMT_NV12) ? FrameFormat::NV12 : FrameFormat::YUVPlanar;
+    fd.chromaW = -((-outW) >> desc->log2_chroma_w);
+    fd.chromaH = -((-outH) >> desc->log2_chroma_h);
+    fd.colorspace = frame->colorspace;
+    fd.colorRange = isJpegYuvFormat(static_cast<AVPixelFormat>(frame->format)) ? AVCOL_RANGE_JPEG : frame->color_range;
+    fd.chromaLoc  = frame->chroma_location;
+    for (int i = 0; i < 3; ++i) {
+        fd.planes[i] = dst[i];
+        fd.linesize[i] = dst[i] ? dstStride[i] : 0;
+    }
+
+    metrics.scaledFrames.Add();
+    return true;
+}
+
+/* ---- sws_scale 回退路径 ---- */
+bool MediaSession::convertRgbFrame(const AVFrame* frame, FrameData& fd, int outW, int outH)
+{
+    // 格式或尺寸与初始化时不同也能正确处理；输出尺寸不超过 vw x vh，池中槽位总能容纳
+    sws = sws_getCachedContext(sws, frame->width, frame->height,
+                               static_cast<AVPixelFormat>(frame->format),
+                               outW, outH, AV_PIX_FMT_RGB24,
+                               SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!sws) {
+        std::cerr << "Failed to create SwsContext for "
+                  << av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format)) << "\n";
+        return false;
+    }
+
+    // 打开时格式未知的流在第一帧才确定走回退路径，此时再分配帧缓冲池
+    if (framePool.SlotSize() == 0 && !framePool.Init(static_cast<size_t>(vw) * vh * 3, FRAME_POOL_SLOTS)) {
+        std::cerr << "Failed to allocate video frame pool\n";
+        return false;
+    }
+
+    // 直接转换到池化缓冲区，不再经过中间缓冲拷贝
+    fd.data = acquireFrameBuffer(static_cast<size_t>(outW) * outH * 3);
+    if (!fd.data) return false;
+
+    uint8_t* dst[4] = {fd.data, nullptr, nullptr, nullptr};
+    int dstStride[4] = {outW * 3, 0, 0, 0};
+
+    {
+        TRACE_SCOPE("sws_scale(rgb)");
+        sws_scale(sws, frame->data, frame->linesize,
+                  0, frame->height, dst, dstStride);
+    }
+
+    fd.width = outW;
+    fd.height = outH;
+    fd.format = FrameFormat::RGB24;
+    fd.planes[0] = fd.data;
+    fd.linesize[0] = outW * 3;
+    return true;
+}
+
+/* ---- 帧缓存 ---- */
+// 解码阶段：按送显时的布局（着色器 YUV 格式原样，其余格式 RGB24）保存副本，已有同一 PTS 的帧时跳过
+void MediaSession::cacheFrame(const AVFrame* frame)
+{
+    if (!frameCache.Enabled()) return;
+    double pts = framePts(frame);
+    if (pts < 0) return;
+
+    TRACE_SCOPE("cacheFrame");
+    StageTimer timer;
+    auto pixFmt = static_cast<AVPixelFormat>(frame->format);
+    AVColorRange range = isJpegYuvFormat(pixFmt) ? AVCOL_RANGE_JPEG : frame->color_range;
+    bool inserted = isShaderYuvFormat(pixFmt)
+        ? frameCache.Insert(frame, pts, scaleYuvFormat(pixFmt), scaleYuvFormat(pixFmt), range)
+        : frameCache.Insert(frame, pts, pixFmt, AV_PIX_FMT_RGB24, range);
+    // 已缓存的帧（seek 后重新解出）不计入插入耗时
+    if (inserted) metrics.cacheInsert.RecordMicros(timer.ElapsedMicros());
+}
+
+// 渲染线程：缓存中有 pts 半帧以内的帧时暂存为下一次 PickFrame 的结果
+bool MediaSession::showCachedFrame(double pts)
+{
+    AVFrame* ref = frameCache.Find(pts, 0.5 / videoFPS);
+    if (!ref) return false;
+
+    FrameData fd;
+    fd.pts = framePts(ref);
+    bool ok;
+    if (ref->format == AV_PIX_FMT_RGB24) {
+        fd.width = ref->width;
+        fd.height = ref->height;
+        fd.format = FrameFormat::RGB24;
+        fd.frame = ref;
+        fd.planes[0] = ref->data[0];
+        fd.linesize[0] = ref->linesize[0];
+        ok = true;
+    } else {
+        ok = refYuvFrame(ref, fd);
+        av_frame_free(&ref);
+    }
+    if (!ok) return false;
+
+    // 与 processVideoFrame 一致：缩小后的副本按原始高度猜测色彩空间
+    int sourceH = fmt->streams[vIdx]->codecpar->height;
+    if (fd.format != FrameFormat::RGB24 && fd.colorspace == AVCOL_SPC_UNSPECIFIED && fd.height != sourceH) {
+        fd.colorspace = sourceH >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+    }
+    fd.serial = playSerial.load();
+    fd.queuedAt = std::chrono::steady_clock::now();
+
+    discardCachedFrame();
+    cachedFrame = fd;
+    hasCachedFrame = true;
+    coveredPts = fd.pts;
+    return true;
+}
+
+void MediaSession::discardCachedFrame()
+{
+    if (!hasCachedFrame) return;
+    releaseFrame(cachedFrame);
+    cachedFrame = FrameData();
+    hasCachedFrame = false;
+}
+
+// 队列中不晚于已显示位置的帧：缓存命中之后流水线解出的同一帧，或逐帧前进时已经看过的帧
+void MediaSession::dropCoveredFrames()
+{
+    if (coveredPts < 0) return;
+    const double limit = coveredPts + 0.5 / videoFPS;
+    const FrameData* next;
+    FrameData fd;
+    while ((next = vq.Peek()) && next->pts >= 0 && next->pts < limit) {
+        vq.TryPop(fd);
+        releaseFrame(fd);
+        frameConsumed();
+    }
+}
+
+/* ---- 帧缓冲 ---- */
+void MediaSession::releaseFrame(FrameData& fd)
+{
+    if (fd.frame) {
+        av_frame_unref(fd.frame);
+        std::lock_guard<std::mutex> lock(shellMtx);
+        if (frameShells.size() < FRAME_POOL_SLOTS) {
+            frameShells.push_back(fd.frame);
+        } else {
+            av_frame_free(&fd.frame);
+        }
+        fd.frame = nullptr;
+    } else {
+        framePool.Release(fd.data);
+    }
+    fd.data = nullptr;
+}
+
+AVFrame* MediaSession::acquireFrameShell()
+{
+    {
+        std::lock_guard<std::mutex> lock(shellMtx);
+        if (!frameShells.empty()) {
+            AVFrame* shell = frameShells.back();
+            frameShells.pop_back();
+            return shell;
+        }
+    }
+    return av_frame_alloc();
+}
+
+uint8_t* MediaSession::acquireFrameBuffer(size_t size)
+{
+    FramePool::Source source;
+    uint8_t* buf = framePool.Acquire(size, &source);
+
+    if (source != FramePool::Source::Pool) {
+        metrics.poolAllocs.Add();
+        if (source == FramePool::Source::HeapExhausted) metrics.poolExhausted.Add();
+    }
+
+    if (!buf) std::cerr << "Failed to allocate frame buffer\n";
+    return buf;
+}
+
+/* ---- 选帧（渲染线程） ---- */
+bool MediaSession::PickFrame(Clock::time_point now, Clock::time_point nextVsync, double vsyncPeriod, FrameData& fd)
+{
+    TRACE_SCOPE("PickFrame");
+    // 任务池模式下音频任务因 PCM 缓冲区满而挂起后，由渲染线程每个 vsync 检查一次设备是否已腾出空间
+    kickStage(audioTask);
+
+    // 丢弃 seek 之前解出的旧帧
+    dropStaleFrames();
+    dropCoveredFrames();
+
+    // seek / 逐帧命中帧缓存：立即显示
+    if (hasCachedFrame) {
+        fd = cachedFrame;
+        cachedFrame = FrameData();
+        hasCachedFrame = false;
+        stepPending = false;
+        pendingPresentPts = fd.pts;
+        if (firstFramePending.exchange(false)) firstPresentPending = true;
+        return true;
+    }
+
+    const FrameData* next = vq.Peek();
+    if (!next) {
+        return false;
+    }
+
+    // ===== 按 vsync 选帧 =====
+    // 选出 PTS 最接近下一次 vsync 显示时刻的帧；之前到期但未显示的帧直接丢弃
+    double lead = std::chrono::duration<double>(nextVsync - now).count();
+
+    bool picked = false;
+    if (seekDisplayPending || firstFramePending || stepPending || next->pts < 0) {
+        // 播放或 seek 后的第一帧、逐帧前进的帧、没有时间戳的帧：立即显示，不等待音频时钟
+        vq.TryPop(fd);
+        frameConsumed();
+        picked = true;
+        stepPending = false;
+    } else {
+        // Video / External 主时钟以这一帧落在下一次 vsync 上为起点建立
+        MediaClock* anchor = anchorClock();
+        if (anchor && !anchor->Valid()) {
+            anchor->Set(next->pts, nextVsync);
+        }
+
+        double target = masterClock(now) + lead;
+        double window = vsyncPeriod * 0.5;
+        if (syncMode == SyncMode::Video) {
+            // 视频主时钟不丢帧：每次 vsync 最多显示一帧；落后超过一帧时把时钟回拨到这一帧，由音频变速跟上
+            if (next->pts <= target + window) {
+                if (next->pts < target - 1.0 / videoFPS) {
+                    videoClock.Set(next->pts, nextVsync);
+                    metrics.clockRebases.Add();
+                }
+                vq.TryPop(fd);
+                frameConsumed();
+                picked = true;
+            }
+        }
+        while (syncMode != SyncMode::Video &&
+               (next = vq.Peek()) && (next->pts < 0 || next->pts <= target + window)) {
+            if (picked) {
+                // 下一帧同样已到期：当前候选帧不再显示
+                metrics.presentDrops.Add();
+                releaseFrame(fd);
+            }
+            vq.TryPop(fd);
+            frameConsumed();
+            picked = true;
+        }
+    }
+
+    if (!picked) {
+        return false;
+    }
+    pendingPresentPts = fd.pts;
+    if (firstFramePending.exchange(false)) firstPresentPending = true;
+    metrics.queueWait.RecordMicros(std::chrono::duration<double, std::micro>(now - fd.queuedAt).count());
+    return true;
+}
+
+/* ---- 帧已上传（渲染线程） ---- */
+void MediaSession::FrameShown(FrameData& fd, Clock::time_point pickedAt)
+{
+    if (fd.pts >= 0) currentPts.store(fd.pts);
+
+    // seek 之后的第一帧：记录从请求到首帧显示的延迟
+    if (seekDisplayPending) {
+        seekDisplayPending = false;
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - seekStart).count();
+        metrics.seeks.Add();
+        metrics.seek.RecordMicros(ms * 1000.0);
+        std::cout << "[Seek] first frame " << std::fixed << std::setprecision(3) << fd.pts
+                  << "s after " << std::setprecision(1) << ms << " ms\n";
+    }
+
+    // 上传完成，归还帧缓冲
+    releaseFrame(fd);
+
+    // 相对主时钟的同步数据（音画误差的连续统计见 Presented）
+    metrics.framesShown.Add();
+    if (fd.pts >= 0) {
+        double master = masterClock(pickedAt);
+        if (!std::isnan(master) && (syncMode != SyncMode::Audio || audioReady.load())) {
+            double diff = fd.pts - master;
+            if (diff < -0.01) {
+                metrics.lateFrames.Add();
+            }
+
+            #if DEBUG_ENABLED
+            // 调试输出
+            if (debugOutput) {
+                std::ostringstream oss;
+                oss << "Frame PTS: " << std::fixed << std::setprecision(3) << fd.pts
+                    << " | " << SyncModeName(syncMode) << " clock: " << master
+                    << " | Diff: " << diff * 1000 << " ms";
+                logDebug(oss.str());
+            }
+            #endif
+        }
+    }
+}
+
+/* ---- 主时钟 ---- */
+// Video / External 时钟尚未建立时返回 NAN
+double MediaSession::masterClock(std::chrono::steady_clock::time_point now) const
+{
+    switch (syncMode) {
+        case SyncMode::Audio: return getAudioClock();
+        case SyncMode::Video: return videoClock.Get(now);
+        default:              return extClock.Get(now);
+    }
+}
+
+// 由渲染线程在 vsync 上建立的主时钟；音频主时钟由设备回调推算，返回 nullptr
+MediaClock* MediaSession::anchorClock()
+{
+    switch (syncMode) {
+        case SyncMode::Video:    return &videoClock;
+        case SyncMode::External: return &extClock;
+        default:                 return nullptr;
+    }
+}
+
+/* ---- 显示完成（SwapWindow 返回后） ---- */
+void MediaSession::Presented(Clock::time_point now)
+{
+    // 连续记录音画误差：刚显示的帧相对音频实际播放位置，与主时钟模式无关
+    if (pendingPresentPts >= 0 && !paused && audioDev && aIdx != -1 && audioReady.load()) {
+        avError.Add((pendingPresentPts - getAudioClock()) * 1000.0);
+        metrics.avErrorMs.Set(avError.ewma);
+    }
+
+    // 记录刚显示的帧相对主时钟的偏差（正值表示晚于 PTS 显示）
+    if (pendingPresentPts >= 0 && !paused && (syncMode != SyncMode::Audio || audioReady.load())) {
+        double master = masterClock(now);
+        if (!std::isnan(master)) {
+            double errMs = (master - pendingPresentPts) * 1000.0;
+            presentError.Add(errMs);
+            metrics.presentError.RecordMicros(std::abs(errMs) * 1000.0);
+        }
+    }
+    pendingPresentPts = -1.0;
+
+    // 第一帧随本轮 SwapWindow 显示：记录启动耗时
+    if (firstPresentPending) {
+        firstPresentPending = false;
+        startup.firstFrameShownMs = sinceStartup();
+        std::cout << "[Startup] first frame after " << std::fixed << std::setprecision(1) << startup.firstFrameShownMs
+                  << " ms (input " << startup.inputOpenedMs
+                  << ", stream info " << startup.streamInfoMs << (startup.streamInfoSkipped ? " skipped" : "")
+                  << ", GL " << startup.glReadyMs
+                  << ", loaded " << startup.mediaLoadedMs
+                  << ", decoded " << startup.firstFrameQueuedMs << ")\n";
+    }
+}
+
+/* ---- 丢弃旧序号的帧 ---- */
+void MediaSession::dropStaleFrames()
+{
+    const int serial = playSerial.load();
+    const FrameData* next;
+    FrameData fd;
+    while ((next = vq.Peek()) && next->serial != serial) {
+        vq.TryPop(fd);
+        releaseFrame(fd);
+        frameConsumed();
+    }
+}
+
+/* ---- 资源释放 ---- */
+void MediaSession::CleanUp()
+{
+    Stop();
+    if (openThread.joinable()) openThread.join();
+
+    // 释放FFmpeg资源
+    if (pkt) av_packet_free(&pkt);
+    if (vf) av_frame_free(&vf);
+    if (af) av_frame_free(&af);
+    if (vc) avcodec_free_context(&vc);
+    decArena.Destroy(); // 解码器释放后，池中的帧缓冲不再被引用
+    if (ac) avcodec_free_context(&ac);
+    if (fmt) avformat_close_input(&fmt);
+    input.Close();   // 自定义 I/O 不随 avformat_close_input 释放
+    if (sws) sws_freeContext(sws);
+    if (scaleSws) sws_freeContext(scaleSws);
+    if (swr) swr_free(&swr);
+    framePool.Destroy();
+    for (AVFrame*& shell : frameShells) av_frame_free(&shell);
+    frameShells.clear();
+    frameCache.Clear();
+    if (audBuf) av_freep(&audBuf);
+    audBufSize = 0;
+
+    // 重置指针
+    pkt = nullptr;
+    vf = nullptr;
+    af = nullptr;
+    vc = nullptr;
+    ac = nullptr;
+    fmt = nullptr;
+    sws = nullptr;
+    scaleSws = nullptr;
+    swr = nullptr;
+    audBuf = nullptr;
+
+    // 先关闭设备停止回调，再释放回调读取的环形缓冲区
+    if (audioDev) SDL_CloseAudioDevice(audioDev);
+    audioDev = 0;
+    pcmRing.Destroy();
+    if (audioSubsystem) {
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        audioSubsystem = false;
+    }
+}
+
+#if DEBUG_ENABLED
+/* ==================== 调试功能实现 ==================== */
+
+void MediaSession::logDebug(const std::string& message) const {
+    std::cout << "[DEBUG] " << message << "\n";
+
+    // 可选：记录到文件
+    static std::ofstream logFile("av_sync.log", std::ios::app);
+    if (logFile.is_open()) {
+        auto now = std::chrono::system_clock::now();
+        auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()).count();
+
+        logFile << now_ms << " | " << message << "\n";
+    }
+}
+
+void MediaSession::ToggleDebugOutput() {
+    debugOutput = !debugOutput;
+    std::cout << "Debug output " << (debugOutput ? "ENABLED" : "DISABLED") << "\n";
+}
+
+#endif
+
+/* ==================== 运行指标 ==================== */
+
+// 导出线程在每次快照前调用：队列深度只在这里采样，不给各线程的热路径增加开销
+void MediaSession::sampleGauges() {
+    metrics.videoQueue.Set(static_cast<double>(vq.Size()));
+    metrics.videoPacketSec.Set(videoPq.Duration());
+    metrics.audioPacketSec.Set(audioPq.Duration());
+    metrics.cacheBytes.Set(static_cast<double>(frameCache.Bytes()));
+    metrics.cacheFrames.Set(static_cast<double>(frameCache.Count()));
+}
+
+void MediaSession::ResetStats() {
+    metrics.registry.Reset();
+    presentError.Clear();
+    avError.Clear();
+}
+
+void MediaSession::printPresentHistogram() const {
+    const ErrorHistogram& h = presentError;
+    if (h.total == 0) return;
+
+    std::cout << "显示时间误差: 平均 |误差| " << h.sumAbs / h.total
+              << " ms, 最大 " << h.maxAbs << " ms, 样本 " << h.total << "\n";
+
+    uint64_t peak = *std::max_element(std::begin(h.counts), std::end(h.counts));
+    for (int i = 0; i < ErrorHistogram::BUCKETS; ++i) {
+        if (h.counts[i] == 0) continue;
+        std::ostringstream label;
+        if (i == 0) {
+            label << "< " << ErrorHistogram::BucketLow(1);
+        } else if (i == ErrorHistogram::BUCKETS - 1) {
+            label << ">= " << ErrorHistogram::BucketLow(i);
+        } else {
+            label << ErrorHistogram::BucketLow(i) << " .. " << ErrorHistogram::BucketLow(i + 1);
+        }
+        int bar = static_cast<int>(40 * h.counts[i] / peak);
+        std::cout << "  " << std::setw(14) << label.str() << " ms | "
+                  << std::string(std::max(bar, 1), '#') << " " << h.counts[i] << "\n";
+    }
+}
+
+void MediaSession::PrintStats() const {
+    const SessionMetrics& m = metrics;
+    if (m.framesShown.Value() == 0) {
+        std::cout << "No frames rendered yet.\n";
+        return;
+    }
+
+    std::cout << "\n===== 音画同步统计 =====\n";
+    std::cout << "已渲染帧数: " << m.framesShown.Value() << "\n";
+    std::cout << "停止时丢弃帧数: " << m.stopDrops.Value() << "\n";
+    std::cout << "解码端丢弃迟到帧: " << m.lateDecodeDrops.Value()
+              << " (迟到但保留 " << m.lateKept.Value() << ")\n";
+    std::cout << "显示端丢弃帧: " << m.presentDrops.Value() << "\n";
+    if (m.nonrefEnter.Value() > 0) {
+        std::cout << "跳过非参考帧: 进入 " << m.nonrefEnter.Value()
+                  << " 次, 恢复 " << m.nonrefExit.Value() << " 次\n";
+    }
+    std::cout << "延迟帧数: " << m.lateFrames.Value() << "\n";
+    std::cout << "音频欠载次数: " << m.audioUnderruns.Value() << "\n";
+
+    // 各阶段延迟（微秒）
+    for (const LatencyHistogram* h : {&m.demux, &m.videoDecode, &m.audioDecode, &m.convert, &m.cacheInsert,
+                                      &m.queueWait, &m.uploadPbo, &m.uploadDirect, &m.present}) {
+        HistogramSnapshot snap = h->Snapshot();
+        if (snap.count == 0) continue;
+        std::cout << std::left << std::setw(14) << h->Name() << std::right << " " << snap.count
+                  << " 次, 平均 " << snap.MeanMicros() << " us, p50 " << snap.PercentileMicros(0.50)
+                  << " us, p99 " << snap.PercentileMicros(0.99) << " us, 最大 " << snap.MaxMicros() << " us\n";
+    }
+    if (m.pboBusySkips.Value() > 0) {
+        std::cout << "PBO 忙而退回直接上传: " << m.pboBusySkips.Value() << " 次\n";
+    }
+    printPresentHistogram();
+    std::cout << "帧缓冲堆分配: " << m.poolAllocs.Value()
+              << " (池耗尽 " << m.poolExhausted.Value() << " 次, 池容量 "
+              << framePool.SlotCount() << ")\n";
+    if (m.scaledFrames.Value() > 0) {
+        std::cout << "按视口缩小的帧数: " << m.scaledFrames.Value() << "\n";
+    }
+    std::cout << "解码器内存池: 槽位 " << decArena.SlotSize() / 1024 << " KB x " << decArena.SlotCount()
+              << ", 峰值占用 " << decArena.HighWater()
+              << ", 堆回退 " << decArena.HeapAllocs()
+              << ", 默认分配器 " << decArena.DefaultAllocs() << "\n";
+    if (frameCache.Enabled()) {
+        uint64_t hits = m.cacheHits.Value(), lookups = hits + m.cacheMisses.Value();
+        std::cout << "帧缓存: " << frameCache.Count() << " 帧, " << frameCache.Bytes() / (1024.0 * 1024.0)
+                  << " / " << frameCache.Budget() / (1024 * 1024) << " MB (1/" << frameCache.Scale() << " 尺寸"
+                  << (frameCache.Yuv420() ? ", 4:2:0" : "") << "), 命中 " << hits << " / " << lookups << " 次";
+        if (lookups > 0) std::cout << " (" << 100.0 * hits / lookups << "%)";
+        std::cout << ", 淘汰 " << frameCache.Evictions() << " 帧\n";
+    }
+    if (input.Context()) {
+        InputStats io = input.Stats();
+        std::cout << "输入 I/O (" << InputModeName(input.Mode()) << "): " << io.bytes / (1024 * 1024) << " MB, "
+                  << io.reads << " 次读取, 平均 " << (io.reads ? io.readMicros / io.reads : 0.0)
+                  << " us, 最大 " << io.maxReadMicros << " us, 等待 " << io.stalls << " 次 / "
+                  << io.stallMicros / 1000.0 << " ms\n";
+    }
+    std::cout << "主时钟: " << SyncModeName(syncMode);
+    if (syncMode == SyncMode::Video) std::cout << ", 回拨 " << m.clockRebases.Value() << " 次";
+    if (syncMode != SyncMode::Audio) std::cout << ", 音频变速校正 " << m.driftCorrections.Value() << " 帧";
+    std::cout << "\n";
+    if (avError.count > 0) {
+        std::cout << "音画误差(视频相对音频): 平均 " << avError.mean << " ms, 标准差 " << avError.StdDev()
+                  << " ms, 当前 " << avError.ewma << " ms, 最大 |误差| " << avError.hist.maxAbs
+                  << " ms, 样本 " << avError.count << "\n";
+    }
+    HistogramSnapshot seek = m.seek.Snapshot();
+    if (seek.count > 0) {
+        std::cout << "Seek 次数: " << seek.count
+                  << ", 首帧延迟 平均/p90/最大: " << seek.MeanMicros() / 1000.0 << " / "
+                  << seek.PercentileMicros(0.90) / 1000.0 << " / "
+                  << seek.MaxMicros() / 1000.0 << " ms\n";
+    }
+    std::cout << "========================\n";
+}
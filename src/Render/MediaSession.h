@@ -0,0 +1,402 @@
+#ifndef MEDIASESSION_H
+#define MEDIASESSION_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <climits>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "VideoFrame.h"
+#include "FramePool.h"
+#include "FrameCache.h"
+#include "SpscRing.h"
+#include "PacketQueue.h"
+#include "PlayerOptions.h"
+#include "PipelineTimings.h"
+#include "KeyframeIndex.h"
+#include "PcmRing.h"
+#include "DecoderArena.h"
+#include "MediaInput.h"
+#include "SyncClock.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "TaskScheduler.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+#include <libswresample/swresample.h>
+}
+
+// 调试模式控制：实时调试日志和队列状态输出（Debug 配置下由 CMake 定义 ENABLE_DEBUG）。
+// 运行指标不受影响，始终收集
+#ifdef ENABLE_DEBUG
+    #define DEBUG_ENABLED 1
+#else
+    #define DEBUG_ENABLED 0
+#endif
+
+// 一路媒体的播放流水线：解复用、音视频解码、帧队列、主时钟与 seek。
+// 不依赖窗口和 GL 上下文，同一进程可以同时运行多个会话；帧由渲染方（PlayerRender、VideoWall）
+// 在自己的渲染线程中用 PickFrame / FrameShown / Presented 取出并上传。
+// 音频输出：会话自己打开一个 SDL 音频设备（音频子系统按会话引用计数），
+// opts.disableAudio 时忽略音频流，主时钟退回 External。
+// 流水线默认每个阶段一个专用线程；opts.sharedPool 时各阶段改为提交到进程共享的 TaskScheduler 的任务，
+// 多个会话共用按核数创建的工作线程。
+// 解码出的帧另在 FrameCache 中按 PTS 保留副本（opts.frameCacheMB），逐帧后退和缓存范围内的 seek 直接显示缓存帧
+class MediaSession {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit MediaSession(const PlayerOptions& options = PlayerOptions());
+    ~MediaSession();
+
+    MediaSession(const MediaSession&) = delete;
+    MediaSession& operator=(const MediaSession&) = delete;
+
+    // 启动耗时的起点（只有第一次调用生效）；渲染方完成窗口与 GL 初始化后调用 MarkGlReady
+    void MarkStartup();
+    void MarkGlReady();
+
+    // 视频输出尺寸上限。DisplayLimit 为这一路在显示器上可能的最大视口，决定解码器 lowres 级别和
+    // 缩放缓冲池的槽位大小，需在 LoadMedia 之前设置；OutputLimit 为当前视口，解码线程下一帧起按它缩小。
+    // 0 表示不限制；opts.adaptiveSize 关闭时忽略
+    void SetDisplayLimit(int w, int h);
+    void SetOutputLimit(int w, int h);
+
+    // 在后台线程打开解复用器（探测、流信息），与窗口/GL 初始化并行；LoadMedia 等待其完成
+    void OpenMediaAsync(const std::string& file);
+    bool LoadMedia(const std::string& file);
+    void Play();
+    void Pause();
+    void Stop();
+    void Seek(double seconds);
+    // 逐帧前进（direction > 0）或后退（< 0），播放中先暂停。后退经 seek 定位，帧缓存命中时立即显示；
+    // 前进显示队列中的下一帧，队列尚未接上时先查帧缓存
+    void StepFrame(int direction);
+    // 无窗口消费：不做音画同步，尽快取出解码帧直到解码结束；之后由调用方 Stop。
+    // sink 非空时每一帧先交给它（如原始帧导出），返回后帧缓冲即被归还；sink 返回 false 时提前结束
+    void RunHeadless(const std::function<bool(const FrameData&)>& sink = nullptr);
+    void CleanUp();
+
+    // ===== 渲染线程接口 =====
+    // 本轮需要选帧：播放中且未暂停，或暂停状态下 seek 的第一帧、逐帧前进的帧、帧缓存命中的帧尚未显示
+    bool WantsFrame() const { return playing && (!paused || seekDisplayPending || stepPending || hasCachedFrame); }
+    // 按预测的下一次 vsync 显示时刻选出要显示的帧；没有到期的帧时返回 false
+    bool PickFrame(Clock::time_point now, Clock::time_point nextVsync, double vsyncPeriod, FrameData& fd);
+    // 选出的帧已上传：记录统计并归还帧缓冲
+    void FrameShown(FrameData& fd, Clock::time_point pickedAt);
+    // 本轮 SwapWindow 完成：记录显示误差与启动耗时
+    void Presented(Clock::time_point now);
+
+    bool   Playing() const { return playing; }
+    bool   Paused() const { return paused; }
+    double Position() const { return currentPts.load(); }   // 最近显示帧的 PTS
+    bool   HasAudioOutput() const { return audioDev != 0; }
+
+    // 流水线阶段耗时（需开启 PlayerOptions::collectTimings，在 Stop 之后读取）
+    const PipelineTimings& Timings() const { return timings; }
+    InputStats IoStats() const { return input.Stats(); }
+    const StartupTimings& Startup() const { return startup; }
+    InputMode  ActiveInputMode() const { return input.Context() ? input.Mode() : InputMode::Default; }
+    SyncMode   ActiveSyncMode() const { return syncMode; }
+    // 显示帧 PTS 相对音频时钟的误差（毫秒，正值为视频超前），每显示一帧记录一次；在渲染线程读取
+    const SyncErrorStats& SyncError() const { return avError; }
+    // 常开的运行指标，可在任意线程读取快照
+    const MetricsRegistry& Metrics() const { return metrics.registry; }
+    int    VideoWidth()  const { return vw; }
+    int    VideoHeight() const { return vh; }
+    float  AspectRatio() const { return (vw > 0 && vh > 0) ? static_cast<float>(vw) / vh : 16.0f / 9.0f; }
+    const PlayerOptions& Options() const { return opts; }
+
+    // 运行指标：各线程无锁写入（计数器按线程分片，延迟直方图对数分桶），开销低到可以常开。
+    // opts.metricsFile 非空时由 metricsExporter 定期导出 JSON Lines
+    struct SessionMetrics {
+        MetricsRegistry registry;
+
+        Counter& framesShown     = registry.AddCounter("frames_shown");       // 已显示（无窗口模式为已消费）的帧
+        Counter& stopDrops       = registry.AddCounter("stop_drops");         // 停止时未能入队的帧
+        Counter& lateDecodeDrops = registry.AddCounter("late_decode_drops");  // 解码端丢弃的迟到帧（未做转换）
+        Counter& lateKept        = registry.AddCounter("late_kept");          // 迟到但因连续丢弃达到上限而保留的帧
+        Counter& presentDrops    = registry.AddCounter("present_drops");      // 显示端被更新的到期帧取代而丢弃的帧
+        Counter& nonrefEnter     = registry.AddCounter("nonref_enter");       // 过载时切换为跳过非参考帧的次数
+        Counter& nonrefExit      = registry.AddCounter("nonref_exit");        // 恢复正常解码的次数
+        Counter& lateFrames      = registry.AddCounter("late_frames");        // 显示时已晚于主时钟 10ms 以上的帧
+        Counter& poolAllocs      = registry.AddCounter("pool_allocs");        // 帧缓冲堆分配次数（稳态应为 0）
+        Counter& poolExhausted   = registry.AddCounter("pool_exhausted");     // 帧缓冲池耗尽次数
+        Counter& scaledFrames    = registry.AddCounter("scaled_frames");      // 按视口缩小后上传的帧数
+        Counter& seeks           = registry.AddCounter("seeks");
+        Counter& clockRebases    = registry.AddCounter("clock_rebases");      // Video 主时钟因视频落后而回拨的次数
+        Counter& audioUnderruns  = registry.AddCounter("audio_underruns");    // 音频回调数据不足（SDL 音频线程）
+        Counter& driftCorrections = registry.AddCounter("drift_corrections"); // 音频变速校正的帧数
+        Counter& pboBusySkips    = registry.AddCounter("pbo_busy_skips");     // PBO 忙而退回直接上传（渲染方记录）
+        Counter& cacheHits       = registry.AddCounter("frame_cache_hits");   // seek / 逐帧直接由帧缓存显示
+        Counter& cacheMisses     = registry.AddCounter("frame_cache_misses"); // seek / 逐帧需要重新解码
+
+        Gauge& videoQueue      = registry.AddGauge("video_queue_frames");
+        Gauge& videoPacketSec  = registry.AddGauge("video_packet_seconds");
+        Gauge& audioPacketSec  = registry.AddGauge("audio_packet_seconds");
+        Gauge& avErrorMs       = registry.AddGauge("av_error_ewma_ms");
+        Gauge& cacheBytes      = registry.AddGauge("frame_cache_bytes");
+        Gauge& cacheFrames     = registry.AddGauge("frame_cache_frames");
+
+        // 延迟（微秒）
+        LatencyHistogram& demux        = registry.AddHistogram("demux");          // av_read_frame
+        LatencyHistogram& videoDecode  = registry.AddHistogram("video_decode");   // 按包
+        LatencyHistogram& audioDecode  = registry.AddHistogram("audio_decode");   // 按包，含重采样
+        LatencyHistogram& convert      = registry.AddHistogram("convert");        // 按帧
+        LatencyHistogram& cacheInsert  = registry.AddHistogram("cache_insert");   // 按帧，帧缓存副本的拷贝 / 缩小
+        LatencyHistogram& queueWait    = registry.AddHistogram("queue_wait");     // 帧在 vq 中停留
+        LatencyHistogram& uploadPbo    = registry.AddHistogram("upload_pbo");     // 纹理上传的 CPU 提交时间（渲染方记录）
+        LatencyHistogram& uploadDirect = registry.AddHistogram("upload_direct");
+        LatencyHistogram& present      = registry.AddHistogram("present");        // SDL_GL_SwapWindow（渲染方记录）
+        LatencyHistogram& presentError = registry.AddHistogram("present_error");  // |显示时刻 - 主时钟|
+        LatencyHistogram& seek         = registry.AddHistogram("seek");           // seek 请求到首帧显示
+    };
+    SessionMetrics& Stats() { return metrics; }
+
+    void ResetStats();
+    void PrintStats() const;
+    #if DEBUG_ENABLED
+    void ToggleDebugOutput();
+    #endif
+
+private:
+    static constexpr int MAX_VQ = 48;
+    static constexpr int AUDIO_CACHE_MS = 1000;
+    static constexpr double SYNC_THRESHOLD = 0.03; // 30ms同步阈值：音频跟随其他主时钟时，平均偏差超过它才变速校正
+    static constexpr int MAX_LATE_DROPS = 8;       // 解码端最多连续丢弃的迟到帧数，之后强制送显一帧保持画面更新
+    // 共享任务池模式下每个阶段任务一次最多处理的包数，之后重新排队，让出工作线程给其他会话
+    static constexpr int DEMUX_TASK_PACKETS = 32;
+    static constexpr int VIDEO_TASK_PACKETS = 4;
+    static constexpr int AUDIO_TASK_PACKETS = 8;
+
+    PlayerOptions opts;
+
+    SDL_AudioDeviceID audioDev = 0;
+    bool audioSubsystem = false;          // 本会话持有一次 SDL 音频子系统引用
+    int bytesPerSec = 0;
+
+    MediaInput       input;               // 自定义输入（mmap / 后台预读），opts.inputMode 为 Default 时不使用
+    AVFormatContext* fmt = nullptr;
+    AVCodecContext *vc = nullptr, *ac = nullptr;
+    SwsContext* sws = nullptr;
+    SwrContext* swr = nullptr;
+    AVPacket*  pkt = nullptr;
+    AVFrame *vf = nullptr, *af = nullptr;
+    int vIdx = -1, aIdx = -1;
+    int vw = 0, vh = 0;
+    int lowres = 0;                       // 解码器 lowres 级别（输出尺寸缩小 2^lowres 倍）
+
+    // 按视口缩小输出：渲染线程在视口变化时更新，解码线程据此选择输出尺寸（0 表示不限制）
+    std::atomic<int> outMaxW{0}, outMaxH{0};
+    int displayW = 0, displayH = 0;       // 显示器上这一路视口的最大尺寸（SetDisplayLimit）
+    int maxOutW = 0, maxOutH = 0;         // 缩放输出的最大尺寸，决定缩放缓冲池的槽位大小
+    SwsContext* scaleSws = nullptr;       // YUV 缩小（解码线程）
+    double videoFPS = 25.0;
+
+    // 解码线程生产、渲染线程消费的无锁视频帧队列
+    SpscRing<FrameData, MAX_VQ> vq;
+    std::mutex   qMtx;                 // 仅用于队列满时解码线程等待
+    std::condition_variable qCv;
+    std::mutex   frameMtx;             // 无窗口消费循环等待新帧（frameProduced 唤醒）
+    std::condition_variable frameCv;
+    // 每个流独立的有界包队列，各自限流
+    static constexpr size_t VIDEO_PQ_BYTES = 64 * 1024 * 1024;
+    static constexpr size_t AUDIO_PQ_BYTES = 8 * 1024 * 1024;
+    static constexpr double PQ_MAX_SECONDS = 5.0;
+    PacketQueue videoPq{VIDEO_PQ_BYTES, PQ_MAX_SECONDS};
+    PacketQueue audioPq{AUDIO_PQ_BYTES, PQ_MAX_SECONDS};
+
+    std::thread  demuxThread;    // av_read_frame，按流分发数据包
+    std::thread  videoThread;    // 视频解码 + 帧处理
+    std::thread  audioThread;    // 音频解码 + 重采样
+    std::atomic<bool> playing{false}, paused{false}, stopReq{false};
+
+    std::atomic<bool>   videoEof{false};   // 视频解码已到达流末尾
+    std::atomic<bool>   demuxEof{false};   // 解复用已读到文件末尾，等待 seek
+    std::atomic<bool>   videoParked{false};   // 任务池模式：有一帧因帧队列满而挂起（vdec.parked），渲染方取帧时据此重新提交
+
+    // 解码状态：线程模式下只由对应的解码线程访问，任务池模式下同一时刻只有一个该阶段的任务在执行
+    struct VideoDecodeState {
+        AVPacket* pkt = nullptr;
+        double skipUntil = -1.0;           // seek 后精确定位：早于该时间的帧直接丢弃
+        int lateRun = 0;                   // 连续丢弃的迟到帧数
+        int windowFrames = 0, windowLate = 0;   // 按窗口统计迟到比例，判断是否持续过载
+        // 任务池模式下帧队列满时不在工作线程上等待：这一帧挂起（videoParked），解码器中剩余的输出留到下一次任务再取
+        FrameData parked;
+        bool receivePending = false;       // 数据包的输出尚未取完
+        bool draining = false;             // 流结束冲刷尚未完成
+    } vdec;
+    struct AudioDecodeState {
+        AVPacket* pkt = nullptr;
+        int frames = 0;
+        int serial = 0;
+        double skipUntil = -1.0;           // seek 后精确定位：早于该时间的样本直接丢弃
+        AudioDriftCorrector drift{SYNC_THRESHOLD};
+    } adec;
+
+    // 共享任务池模式（opts.sharedPool）：每个阶段同一时刻最多一个任务在排队或执行。
+    // 阶段无法推进（包队列空、下游已满）时任务结束并清除 scheduled，由上游投递数据或下游腾出空间时
+    // 调用 kickStage 重新提交；ready 判断阶段能否推进
+    struct StageTask {
+        using Step = bool (MediaSession::*)();
+        StageTask(Step s, Step r) : step(s), ready(r) {}
+        Step step;                         // 处理一批数据，返回 true 表示还有工作、需要重新排队
+        Step ready;
+        TaskPriority priority = TaskPriority::Normal;
+        std::atomic<bool> scheduled{false};
+    };
+    StageTask demuxTask{&MediaSession::demuxTaskStep, &MediaSession::demuxReadyForWork};
+    StageTask videoTask{&MediaSession::videoTaskStep, &MediaSession::videoReadyForWork};
+    StageTask audioTask{&MediaSession::audioTaskStep, &MediaSession::audioReadyForWork};
+    int tasksInFlight = 0;                 // 已提交未结束的阶段任务，由 taskMtx 保护；Stop 等待其归零
+    std::mutex taskMtx;
+    std::condition_variable taskCv;
+
+    // seek：渲染线程发起，解复用线程执行，解码线程与渲染线程按播放序号丢弃旧数据
+    KeyframeIndex       keyIndex;                  // 仅解复用线程访问；与容器索引一致，记录关键帧的 DTS
+    int64_t             keyPtsDelay = -1;          // 关键帧 PTS 相对 DTS 的最大偏移（流时间基），-1 表示尚未读到关键帧
+    std::atomic<bool>   seekReq{false};
+    std::atomic<double> seekTarget{0.0};           // 目标位置（秒）
+    std::atomic<int>    playSerial{0};             // 每次 seek 递增
+    int                 videoDecSerial = 0;        // 视频解码线程当前序号
+    std::atomic<double> currentPts{0.0};           // 最近显示帧的 PTS
+    std::atomic<bool>   seekDisplayPending{false}; // seek 后的第一帧尚未显示
+    Clock::time_point   seekStart;
+
+    PipelineTimings timings;
+
+    // 启动耗时：起点为第一次 MarkStartup（OpenMediaAsync / LoadMedia 或渲染方的初始化）
+    StartupTimings startup;
+    bool startupMarked = false;
+    Clock::time_point startupAt;
+    std::thread openThread;                    // OpenMediaAsync 的解复用器打开线程
+    std::string openFile;
+    bool openOk = false;
+    std::atomic<bool> firstFramePending{false};   // 本次播放的第一帧尚未显示：不等音频时钟，立即显示
+    bool firstPresentPending = false;             // 第一帧已上传，等待本轮 SwapWindow 完成
+    double pendingPresentPts = -1.0;              // 本轮上传、待显示帧的 PTS
+
+    // 主时钟：syncMode 为 LoadMedia 按音频可用性确定的实际模式。
+    // Video / External 模式的时钟由渲染线程在第一帧落到 vsync 时建立，seek 后重新建立
+    SyncMode   syncMode = SyncMode::Audio;
+    MediaClock videoClock;                        // Video 模式：视频落后时回拨到迟到帧，不丢帧
+    MediaClock extClock;                          // External 模式：单调推进
+    SyncErrorStats avError;                       // 显示帧相对音频时钟的误差（渲染线程）
+    ErrorHistogram presentError;                  // 显示时刻相对主时钟的误差分布（渲染线程）
+
+    std::atomic<double> audioWritePts{0.0};   // 已解码音频末尾的 PTS
+    std::atomic<bool>   audioReady{false};
+
+    // 音频解码线程写入、SDL 音频回调拉取的 PCM 环形缓冲区
+    PcmRing             pcmRing;
+    std::atomic<double> clockPts{0.0};        // 最近一次回调交给设备的数据末尾 PTS
+    std::atomic<Clock::rep> clockAt{0};       // 该次回调的时刻
+    double              deviceLatency = 0.0;  // 回调数据到实际播放的延迟（秒）
+
+    // 缩小 / sws_scale 回退路径：解码线程直接写入、渲染线程上传后归还的帧缓冲池
+    // 容量 = 队列上限 + 解码中的一帧 + 上传中的一帧
+    static constexpr int FRAME_POOL_SLOTS = MAX_VQ + 2;
+    FramePool framePool;
+
+    // 零拷贝路径的 AVFrame 外壳：releaseFrame 解除引用后放回，refYuvFrame 取出复用，稳态下不再逐帧分配。
+    // 解码线程取、渲染线程还，由 shellMtx 保护；最多保留 FRAME_POOL_SLOTS 个
+    std::vector<AVFrame*> frameShells;
+    std::mutex            shellMtx;
+
+    // 视频解码器的 get_buffer2 内存池
+    // 容量 = 队列上限 + 解码器参考帧（最多 16）+ 帧级多线程在途帧
+    static constexpr int DECODER_ARENA_SLOTS = MAX_VQ + 32;
+    DecoderArena decArena;
+
+    // 解码帧缓存：视频解码阶段写入，渲染线程在 seek / 逐帧时查找。
+    // 命中的帧暂存在 cachedFrame 中由下一次 PickFrame 取走；coveredPts 为已由缓存或逐帧显示到的位置，
+    // 队列中不晚于它的帧（流水线随后解出的同一帧及更早的帧）不再显示。以下成员只由渲染线程访问
+    FrameCache frameCache;
+    FrameData  cachedFrame;
+    bool       hasCachedFrame = false;
+    bool       stepPending = false;       // 逐帧前进：下一次 PickFrame 立即显示队首帧
+    double     coveredPts = -1.0;
+
+    uint8_t* audBuf = nullptr;
+    unsigned int audBufSize = 0;                  // audBuf 容量（字节），按重采样输出上限增长
+    int audioOutRate = 0;                         // 重采样输出（设备）采样率与声道数
+    int audioOutChannels = 0;
+
+    SessionMetrics metrics;
+    MetricsExporter metricsExporter;
+
+    #if DEBUG_ENABLED
+    bool debugOutput = false;         // 实时调试输出开关
+    #endif
+
+    bool openInput(const std::string& file);
+    double sinceStartup() const;
+    bool openAudio(AVStream*);
+    bool openVideo(AVStream*);
+    void   demuxLoop();
+    bool   demuxOne();
+    void   videoDecodeLoop();
+    void   beginVideoDecode();
+    void   endVideoDecode();
+    void   decodeVideoItem(PacketQueue::Item item, int serial);
+    double receiveVideoFrames();
+    void   drainVideoDecoder();
+    bool   resumeVideoOutput();
+    void   audioDecodeLoop();
+    void   beginAudioDecode();
+    void   endAudioDecode();
+    void   decodeAudioItem(PacketQueue::Item item, int serial);
+    // 共享任务池模式
+    void   startStageTasks();
+    void   waitStageTasks();
+    void   kickStage(StageTask& stage);
+    void   submitStage(StageTask& stage);
+    void   runStage(StageTask& stage);
+    bool   demuxTaskStep();
+    bool   demuxReadyForWork();
+    bool   videoTaskStep();
+    bool   videoReadyForWork();
+    bool   audioTaskStep();
+    bool   audioReadyForWork();
+    bool   audioHasSpace() const;
+    void   frameConsumed();
+    void   frameProduced();
+    void   performSeek();
+    void   dropStaleFrames();
+    static void audioCallback(void* userdata, Uint8* stream, int len);
+    void   fillAudio(Uint8* stream, int len);
+    double getAudioClock() const;
+    double masterClock(Clock::time_point now) const;
+    MediaClock* anchorClock();
+    double framePts(const AVFrame* frame) const;
+    double decodeLateness(double pts) const;
+    void processVideoFrame(AVFrame* frame);
+    bool refYuvFrame(AVFrame* frame, FrameData& fd);
+    bool scaleYuvFrame(const AVFrame* frame, FrameData& fd, int outW, int outH);
+    void releaseFrame(FrameData& fd);
+    AVFrame* acquireFrameShell();
+    void cacheFrame(const AVFrame* frame);
+    bool showCachedFrame(double pts);
+    void discardCachedFrame();
+    void dropCoveredFrames();
+    uint8_t* acquireFrameBuffer(size_t size);
+    bool convertRgbFrame(const AVFrame* frame, FrameData& fd, int outW, int outH);
+    #if DEBUG_ENABLED
+    void logDebug(const std::string& message) const;
+    #endif
+    void sampleGauges();
+    void printPresentHistogram() const;
+};
+
+#endif
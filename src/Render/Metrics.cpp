@@ -0,0 +1,223 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+int MetricThreadShard()
+{
+    static std::atomic<int> nextShard{0};
+    thread_local int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    return shard;
+}
+
+/* ---- Counter ---- */
+uint64_t Counter::Value() const
+{
+    uint64_t total = 0;
+    for (const Shard& s : shards) total += s.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+void Counter::Reset()
+{
+    for (Shard& s : shards) s.value.store(0, std::memory_order_relaxed);
+}
+
+/* ---- LatencyHistogram ---- */
+static int highestBit(uint64_t v)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, v);
+    return static_cast<int>(idx);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+// 小于 SUB 的值各占一个桶；之后每个 [2^k, 2^(k+1)) 区间按最高位之后的 SUB_BITS 位分成 SUB 个桶
+int LatencyHistogram::BucketIndex(uint64_t ns)
+{
+    if (ns < static_cast<uint64_t>(SUB)) return static_cast<int>(ns);
+    int msb = highestBit(ns);
+    if (msb > MAX_BITS) return BUCKETS - 1;
+    int shift = msb - SUB_BITS;
+    int sub = static_cast<int>((ns >> shift) & (SUB - 1));
+    return SUB + shift * SUB + sub;
+}
+
+uint64_t LatencyHistogram::BucketLow(int idx)
+{
+    if (idx < SUB) return static_cast<uint64_t>(idx);
+    int shift = (idx - SUB) / SUB;
+    int sub = (idx - SUB) % SUB;
+    return static_cast<uint64_t>(SUB + sub) << shift;
+}
+
+uint64_t LatencyHistogram::BucketWidth(int idx)
+{
+    return idx < SUB ? 1 : uint64_t(1) << ((idx - SUB) / SUB);
+}
+
+void LatencyHistogram::Record(uint64_t ns)
+{
+    counts[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = maxNs.load(std::memory_order_relaxed);
+    while (ns > prev && !maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const
+{
+    HistogramSnapshot snap;
+    snap.counts.resize(BUCKETS);
+    for (int i = 0; i < BUCKETS; ++i) {
+        snap.counts[i] = counts[i].load(std::memory_order_relaxed);
+        snap.count += snap.counts[i];
+    }
+    snap.sumNs = sumNs.load(std::memory_order_relaxed);
+    snap.maxNs = maxNs.load(std::memory_order_relaxed);
+    return snap;
+}
+
+void LatencyHistogram::Reset()
+{
+    for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+    sumNs.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+double HistogramSnapshot::PercentileMicros(double p) const
+{
+    if (count == 0) return 0.0;
+    uint64_t rank = static_cast<uint64_t>(p * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            int idx = static_cast<int>(i);
+            double mid = LatencyHistogram::BucketLow(idx) + LatencyHistogram::BucketWidth(idx) / 2.0;
+            // 桶中点可能超过实际最大值（最大值所在的桶）
+            return std::min(mid, static_cast<double>(maxNs)) / 1000.0;
+        }
+    }
+    return MaxMicros();
+}
+
+/* ---- MetricsRegistry ---- */
+Counter& MetricsRegistry::AddCounter(const std::string& name)
+{
+    counters.emplace_back(name);
+    return counters.back();
+}
+
+Gauge& MetricsRegistry::AddGauge(const std::string& name)
+{
+    gauges.emplace_back(name);
+    return gauges.back();
+}
+
+LatencyHistogram& MetricsRegistry::AddHistogram(const std::string& name)
+{
+    histograms.emplace_back(name);
+    return histograms.back();
+}
+
+void MetricsRegistry::Reset()
+{
+    for (Counter& c : counters) c.Reset();
+    for (Gauge& g : gauges) g.Reset();
+    for (LatencyHistogram& h : histograms) h.Reset();
+}
+
+void MetricsRegistry::WriteJsonLine(std::ostream& os) const
+{
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1);
+    line << "{\"t_ms\":" << std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - created).count();
+
+    line << ",\"counters\":{";
+    for (size_t i = 0; i < counters.size(); ++i) {
+        line << (i ? "," : "") << '"' << counters[i].Name() << "\":" << counters[i].Value();
+    }
+    line << "},\"gauges\":{";
+    for (size_t i = 0; i < gauges.size(); ++i) {
+        line << (i ? "," : "") << '"' << gauges[i].Name() << "\":" << gauges[i].Value();
+    }
+    line << "},\"histograms\":{";
+    for (size_t i = 0; i < histograms.size(); ++i) {
+        HistogramSnapshot s = histograms[i].Snapshot();
+        line << (i ? "," : "") << '"' << histograms[i].Name() << "\":{"
+             << "\"count\":" << s.count
+             << ",\"mean_us\":" << s.MeanMicros()
+             << ",\"p50_us\":" << s.PercentileMicros(0.50)
+             << ",\"p90_us\":" << s.PercentileMicros(0.90)
+             << ",\"p99_us\":" << s.PercentileMicros(0.99)
+             << ",\"max_us\":" << s.MaxMicros() << "}";
+    }
+    line << "}}\n";
+
+    // 整行一次写出，读取方不会看到半行
+    os << line.str();
+    os.flush();
+}
+
+/* ---- MetricsExporter ---- */
+MetricsExporter::~MetricsExporter() { Stop(); }
+
+bool MetricsExporter::Start(const MetricsRegistry& reg, const std::string& path,
+                            std::chrono::milliseconds every, std::function<void()> sampler)
+{
+    Stop();
+    out.open(path, std::ios::app);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open metrics file: " << path << "\n";
+        return false;
+    }
+    registry = &reg;
+    sample = std::move(sampler);
+    interval = std::max(every, std::chrono::milliseconds(10));
+    stopReq = false;
+    worker = std::thread(&MetricsExporter::loop, this);
+    return true;
+}
+
+void MetricsExporter::Stop()
+{
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopReq = true;
+    }
+    cv.notify_all();
+    worker.join();
+    writeSnapshot();
+    out.close();
+    sample = nullptr;
+    registry = nullptr;
+}
+
+void MetricsExporter::loop()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    auto next = std::chrono::steady_clock::now() + interval;
+    while (!cv.wait_until(lock, next, [this] { return stopReq; })) {
+        lock.unlock();
+        writeSnapshot();
+        lock.lock();
+        next += interval;
+    }
+}
+
+void MetricsExporter::writeSnapshot()
+{
+    if (sample) sample();
+    registry->WriteJsonLine(out);
+}
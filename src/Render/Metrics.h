@@ -0,0 +1,153 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 常开的运行指标。写入路径无锁、无分配：
+// - Counter 按线程分片，每个分片独占一条缓存行，多线程递增互不争用；
+// - LatencyHistogram 对数-线性分桶（HDR 风格，每个 2 的幂区间 16 个子桶，相对误差约 6%），桶计数为 relaxed 原子加。
+// 指标只在注册表构造阶段注册（地址之后不变），快照与导出可在任意线程进行，读到的是近似一致的值。
+
+static constexpr int METRIC_SHARDS = 8;
+static constexpr size_t METRIC_CACHE_LINE = 64;
+
+// 当前线程的分片号：线程第一次写指标时按顺序分配
+int MetricThreadShard();
+
+class Counter {
+public:
+    explicit Counter(std::string name) : name(std::move(name)) {}
+
+    void Add(uint64_t n = 1)
+    {
+        shards[MetricThreadShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t Value() const;
+    void     Reset();
+    const std::string& Name() const { return name; }
+
+private:
+    struct alignas(METRIC_CACHE_LINE) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::string name;
+    Shard shards[METRIC_SHARDS];
+};
+
+// 最近一次设置的瞬时值（队列深度、误差滑动平均等）
+class Gauge {
+public:
+    explicit Gauge(std::string name) : name(std::move(name)) {}
+
+    void   Set(double v) { value.store(v, std::memory_order_relaxed); }
+    double Value() const { return value.load(std::memory_order_relaxed); }
+    void   Reset() { Set(0.0); }
+    const std::string& Name() const { return name; }
+
+private:
+    std::string name;
+    std::atomic<double> value{0.0};
+};
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sumNs = 0;
+    uint64_t maxNs = 0;
+    std::vector<uint64_t> counts;
+
+    double MeanMicros() const { return count ? sumNs / 1000.0 / count : 0.0; }
+    double MaxMicros() const { return maxNs / 1000.0; }
+    // 落在第 p 分位的桶的中点（微秒）
+    double PercentileMicros(double p) const;
+};
+
+// 延迟直方图，纳秒精度记录，覆盖 0 .. 约 2^41 ns（36 分钟），超出部分计入最后一个桶
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB = 1 << SUB_BITS;
+    static constexpr int MAX_BITS = 40;
+    static constexpr int BUCKETS = SUB + (MAX_BITS - SUB_BITS + 1) * SUB;
+
+    explicit LatencyHistogram(std::string name) : name(std::move(name)) {}
+
+    void Record(uint64_t ns);
+    void RecordMicros(double us) { Record(us > 0.0 ? static_cast<uint64_t>(us * 1000.0) : 0); }
+
+    HistogramSnapshot Snapshot() const;
+    void Reset();
+    const std::string& Name() const { return name; }
+
+    static int      BucketIndex(uint64_t ns);
+    static uint64_t BucketLow(int idx);
+    static uint64_t BucketWidth(int idx);
+
+private:
+    std::string name;
+    std::atomic<uint64_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> sumNs{0};
+    std::atomic<uint64_t> maxNs{0};
+};
+
+class MetricsRegistry {
+public:
+    MetricsRegistry() : created(std::chrono::steady_clock::now()) {}
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    Counter&          AddCounter(const std::string& name);
+    Gauge&            AddGauge(const std::string& name);
+    LatencyHistogram& AddHistogram(const std::string& name);
+
+    void Reset();
+    // 一行 JSON：注册表创建以来的毫秒数、各计数器和仪表的值、各直方图的 count/mean/p50/p90/p99/max（微秒）
+    void WriteJsonLine(std::ostream& os) const;
+
+private:
+    std::chrono::steady_clock::time_point created;
+    std::deque<Counter> counters;
+    std::deque<Gauge> gauges;
+    std::deque<LatencyHistogram> histograms;
+};
+
+// 后台线程按固定间隔把注册表快照追加为 JSON Lines；Stop 时再写最后一行
+class MetricsExporter {
+public:
+    MetricsExporter() = default;
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // sample 在每次快照前于导出线程中调用，用来刷新需要主动采样的仪表
+    bool Start(const MetricsRegistry& registry, const std::string& path,
+               std::chrono::milliseconds interval, std::function<void()> sample = nullptr);
+    void Stop();
+    bool Running() const { return worker.joinable(); }
+
+private:
+    void loop();
+    void writeSnapshot();
+
+    const MetricsRegistry* registry = nullptr;
+    std::function<void()> sample;
+    std::chrono::milliseconds interval{1000};
+    std::ofstream out;
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopReq = false;
+};
+
+#endif
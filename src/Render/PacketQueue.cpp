@@ -0,0 +1,145 @@
+#include "PacketQueue.h"
+
+PacketQueue::PacketQueue(size_t maxBytes, double maxDuration)
+    : maxBytes(maxBytes), maxDuration(maxDuration) {}
+
+PacketQueue::~PacketQueue()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    clearLocked();
+}
+
+bool PacketQueue::Put(AVPacket* pkt)
+{
+    AVPacket* copy = av_packet_alloc();
+    if (!copy) return false;
+    av_packet_move_ref(copy, pkt);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    notFull.wait(lock, [this] { return aborted || !full(); });
+    if (aborted) {
+        av_packet_free(&copy);
+        return false;
+    }
+
+    bytes += copy->size;
+    durationTicks += copy->duration;
+    q.push_back({Item::Packet, copy, 0});
+    notEmpty.notify_one();
+    return true;
+}
+
+bool PacketQueue::PutEof()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (aborted) return false;
+    q.push_back({Item::Eof, nullptr, 0});
+    notEmpty.notify_one();
+    return true;
+}
+
+bool PacketQueue::PutFlush(int serial)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (aborted) return false;
+    q.push_back({Item::Flush, nullptr, serial});
+    notEmpty.notify_one();
+    return true;
+}
+
+PacketQueue::Item PacketQueue::Get(AVPacket* pkt, int* serial)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    notEmpty.wait(lock, [this] { return aborted || !q.empty(); });
+    if (aborted) return Item::Aborted;
+    return popLocked(lock, pkt, serial);
+}
+
+PacketQueue::Item PacketQueue::TryGet(AVPacket* pkt, int* serial)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    if (aborted) return Item::Aborted;
+    if (q.empty()) return Item::Empty;
+    return popLocked(lock, pkt, serial);
+}
+
+// 取出队首元素；数据包在解锁后转移给调用方
+PacketQueue::Item PacketQueue::popLocked(std::unique_lock<std::mutex>& lock, AVPacket* pkt, int* serial)
+{
+    Entry e = q.front();
+    q.pop_front();
+    if (e.kind != Item::Packet) {
+        if (serial) *serial = e.serial;
+        return e.kind;
+    }
+
+    bytes -= e.pkt->size;
+    durationTicks -= e.pkt->duration;
+    notFull.notify_one();
+    lock.unlock();
+
+    av_packet_move_ref(pkt, e.pkt);
+    av_packet_free(&e.pkt);
+    return Item::Packet;
+}
+
+void PacketQueue::Flush()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    clearLocked();
+    notFull.notify_all();
+}
+
+void PacketQueue::Abort()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    aborted = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+}
+
+void PacketQueue::Start()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    aborted = false;
+}
+
+size_t PacketQueue::Size()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return q.size();
+}
+
+bool PacketQueue::Full()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return full();
+}
+
+size_t PacketQueue::Bytes()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return bytes;
+}
+
+double PacketQueue::Duration()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return durationTicks * av_q2d(timeBase);
+}
+
+bool PacketQueue::full() const
+{
+    if (bytes >= maxBytes) return true;
+    return q.size() >= MIN_PACKETS && durationTicks * av_q2d(timeBase) >= maxDuration;
+}
+
+void PacketQueue::clearLocked()
+{
+    for (Entry& e : q) {
+        if (e.pkt) av_packet_free(&e.pkt);
+    }
+    q.clear();
+    bytes = 0;
+    durationTicks = 0;
+}
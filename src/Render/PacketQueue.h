@@ -0,0 +1,81 @@
+#ifndef PACKETQUEUE_H
+#define PACKETQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// 解复用线程与单个流的解码线程之间的有界包队列。
+// 每个流一个队列、各自限流：某个流的队列满时只会阻塞解复用线程向该流投递，
+// 另一个流的解码线程仍可继续消费自己队列中已缓冲的数据。
+class PacketQueue {
+public:
+    // maxBytes: 缓冲字节上限；maxDuration: 缓冲时长上限（秒，按包 duration 累加）
+    PacketQueue(size_t maxBytes, double maxDuration);
+    ~PacketQueue();
+
+    PacketQueue(const PacketQueue&) = delete;
+    PacketQueue& operator=(const PacketQueue&) = delete;
+
+    void SetTimeBase(AVRational tb) { timeBase = tb; }
+
+    enum class Item {
+        Packet,   // 普通数据包
+        Eof,      // 流结束，解码线程据此冲刷解码器
+        Flush,    // seek 之后的冲刷标记，解码线程据此 avcodec_flush_buffers 并切换序号
+        Aborted,  // 队列已中止
+        Empty     // 队列为空（仅 TryGet）
+    };
+
+    // 转移 pkt 的引用到队列中；队列满时阻塞，被 Abort 时返回 false
+    bool Put(AVPacket* pkt);
+    bool PutEof();
+    bool PutFlush(int serial);
+
+    // 取出一个元素；Item::Packet 时数据转移到 pkt，Item::Flush 时 serial 为新的播放序号
+    Item Get(AVPacket* pkt, int* serial = nullptr);
+    // 非阻塞版本，供共享任务池中的解码任务使用：队列为空时返回 Item::Empty
+    Item TryGet(AVPacket* pkt, int* serial = nullptr);
+
+    void Flush();
+    void Abort();
+    void Start();
+
+    size_t Size();
+    bool   Full();     // Put 此时会阻塞
+    size_t Bytes();
+    double Duration();
+
+private:
+    struct Entry {
+        Item kind = Item::Packet;
+        AVPacket* pkt = nullptr;
+        int serial = 0;
+    };
+
+    static constexpr size_t MIN_PACKETS = 16; // 时长限制生效前至少缓冲的包数
+
+    bool full() const;
+    Item popLocked(std::unique_lock<std::mutex>& lock, AVPacket* pkt, int* serial);
+    void clearLocked();
+
+    std::deque<Entry> q;
+    std::mutex mtx;
+    std::condition_variable notFull, notEmpty;
+
+    const size_t maxBytes;
+    const double maxDuration;
+    AVRational timeBase{1, 1000};
+
+    size_t bytes = 0;
+    int64_t durationTicks = 0;
+    bool aborted = false;
+};
+
+#endif
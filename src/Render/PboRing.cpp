@@ -0,0 +1,148 @@
+#include "PboRing.h"
+#include <SDL2/SDL.h>
+#include <iostream>
+
+// GL 3.3 核心头文件中没有 ARB_buffer_storage 的定义
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRY* BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+bool PboRing::Init(size_t bytes, int n)
+{
+    Destroy();
+    if (n < 1 || n > MAX_BUFFERS || bytes == 0) return false;
+
+    // glBufferStorage（GL 4.4 / ARB_buffer_storage）只能运行时查询
+    bool storage = SDL_GL_ExtensionSupported("GL_ARB_buffer_storage") &&
+                   SDL_GL_GetProcAddress("glBufferStorage") != nullptr;
+
+    if (storage && create(bytes, n, true)) return true;
+    if (storage) {
+        std::cerr << "Persistent PBO mapping failed, falling back to per-frame mapping\n";
+    }
+    return create(bytes, n, false);
+}
+
+bool PboRing::create(size_t bytes, int n, bool usePersistent)
+{
+    auto bufferStorage = usePersistent ?
+        reinterpret_cast<BufferStorageProc>(SDL_GL_GetProcAddress("glBufferStorage")) : nullptr;
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    count = n;
+    size = bytes;
+    cur = 0;
+    persistent = bufferStorage != nullptr;
+
+    for (int i = 0; i < n; ++i) {
+        Slot& s = slots[i];
+        glGenBuffers(1, &s.pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+        if (persistent) {
+            bufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, mapFlags);
+            s.mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                                                              static_cast<GLsizeiptr>(bytes), mapFlags));
+            if (!s.mapped) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                Destroy();
+                return false;
+            }
+        } else {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_DRAW);
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void PboRing::Destroy()
+{
+    if (active) {
+        Commit();
+        End();
+    }
+
+    for (int i = 0; i < count; ++i) {
+        Slot& s = slots[i];
+        if (s.fence) glDeleteSync(s.fence);
+        if (s.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        if (s.pbo) glDeleteBuffers(1, &s.pbo);
+        s = Slot();
+    }
+    if (count > 0) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    count = 0;
+    size = 0;
+    cur = 0;
+}
+
+bool PboRing::slotReady(Slot& slot)
+{
+    if (!slot.fence) return true;
+
+    // 零超时查询，不阻塞渲染线程
+    GLenum r = glClientWaitSync(slot.fence, 0, 0);
+    if (r == GL_TIMEOUT_EXPIRED) return false;
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    return true;
+}
+
+uint8_t* PboRing::Begin(size_t bytes)
+{
+    if (count == 0 || bytes > size || active) return nullptr;
+
+    Slot& s = slots[cur];
+    if (!slotReady(s)) {
+        busySkips++;
+        return nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+    uint8_t* ptr = s.mapped;
+    if (!ptr) {
+        // 上一次使用已由 fence 确认完成，可以不同步地整体覆盖
+        ptr = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+                                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT |
+                                                     GL_MAP_UNSYNCHRONIZED_BIT));
+        if (!ptr) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return nullptr;
+        }
+    }
+
+    active = true;
+    return ptr;
+}
+
+void PboRing::Commit()
+{
+    if (!active) return;
+
+    // 非持久映射必须先解除映射，才能作为上传源
+    Slot& s = slots[cur];
+    if (!s.mapped) {
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+}
+
+void PboRing::End()
+{
+    if (!active) return;
+    active = false;
+
+    Slot& s = slots[cur];
+    s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    cur = (cur + 1) % count;
+}
@@ -0,0 +1,61 @@
+#ifndef PBORING_H
+#define PBORING_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+// 纹理上传用的像素缓冲对象（PBO）环。
+// 渲染线程把帧数据写入映射后的 PBO，再从 PBO 偏移发起 glTexSubImage2D，由驱动异步拷贝到纹理；
+// 每个缓冲提交后插入 fence，再次使用前只做零超时的查询，缓冲仍在使用时由调用方退回直接上传，从不等待 GPU。
+// 支持 ARB_buffer_storage 时使用持久映射（GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT），否则每帧映射/解除映射。
+// 所有方法只能在持有 GL 上下文的线程调用。
+class PboRing {
+public:
+    static constexpr int MAX_BUFFERS = 3;
+
+    PboRing() = default;
+    ~PboRing() = default; // GL 对象由 Destroy 在上下文销毁前释放
+
+    PboRing(const PboRing&) = delete;
+    PboRing& operator=(const PboRing&) = delete;
+
+    // size: 每个缓冲的字节数；count: 缓冲个数（2～3）
+    bool Init(size_t size, int count);
+    void Destroy();
+
+    // 用法：Begin 写入数据 → Commit → 以 PBO 内偏移为指针发起 glTexSubImage2D → End
+    // 取下一个空闲缓冲并绑定到 GL_PIXEL_UNPACK_BUFFER，返回可写指针；
+    // 缓冲仍被 GPU 使用或尺寸不足时返回 nullptr（不绑定）
+    uint8_t* Begin(size_t size);
+    // 数据写完：非持久映射时解除映射，缓冲保持绑定
+    void Commit();
+    // 上传命令发出之后：插入 fence、解绑并前进到下一个缓冲
+    void End();
+
+    bool   Valid()      const { return count > 0; }
+    bool   Persistent() const { return persistent; }
+    size_t BufferSize() const { return size; }
+    int    BufferCount() const { return count; }
+    int    BusySkips()  const { return busySkips; }
+
+private:
+    struct Slot {
+        GLuint   pbo = 0;
+        GLsync   fence = nullptr;
+        uint8_t* mapped = nullptr;   // 持久映射地址
+    };
+
+    bool create(size_t size, int count, bool usePersistent);
+    bool slotReady(Slot& slot);
+
+    Slot   slots[MAX_BUFFERS];
+    int    count = 0;
+    int    cur = 0;
+    size_t size = 0;
+    bool   persistent = false;
+    bool   active = false;  // Begin 成功、等待 End
+    int    busySkips = 0;   // 缓冲仍在使用而退回直接上传的次数
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include "PcmRing.h"
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+PcmRing::~PcmRing()
+{
+    Destroy();
+}
+
+bool PcmRing::Init(size_t cap, int bps)
+{
+    Destroy();
+
+    capacity = 1;
+    while (capacity < cap) capacity <<= 1;
+    mask = capacity - 1;
+    bytesPerSec = bps;
+
+    buf = static_cast<uint8_t*>(av_malloc(capacity));
+    if (!buf) {
+        capacity = mask = 0;
+        return false;
+    }
+    return true;
+}
+
+void PcmRing::Destroy()
+{
+    if (buf) av_free(buf);
+    buf = nullptr;
+    capacity = mask = 0;
+    readPos = writePos = discardPos = 0;
+    PtsMark m;
+    while (marks.TryPop(m)) {}
+    hasAnchor = false;
+}
+
+size_t PcmRing::Buffered() const
+{
+    return static_cast<size_t>(writePos.load(std::memory_order_acquire) -
+                               readPos.load(std::memory_order_acquire));
+}
+
+size_t PcmRing::freeSpace() const
+{
+    return capacity - Buffered();
+}
+
+/* ---- 生产者 ---- */
+void PcmRing::Mark(double pts)
+{
+    // 标记队列满时丢弃本次标记，回调按字节数从上一个标记推算
+    marks.TryPush({writePos.load(std::memory_order_relaxed), pts});
+}
+
+size_t PcmRing::Write(const uint8_t* data, size_t n)
+{
+    const uint64_t w = writePos.load(std::memory_order_relaxed);
+    n = std::min(n, freeSpace());
+
+    size_t off = static_cast<size_t>(w & mask);
+    size_t first = std::min(n, capacity - off);
+    memcpy(buf + off, data, first);
+    memcpy(buf, data + first, n - first);
+
+    writePos.store(w + n, std::memory_order_release);
+    return n;
+}
+
+bool PcmRing::WaitForSpace(size_t n, std::chrono::milliseconds timeout)
+{
+    if (freeSpace() >= n) return true;
+
+    const uint32_t gen = wakeGen.load();
+    std::unique_lock<std::mutex> lock(mtx);
+    writerWaiting = true;
+    // 回调通知时不持锁，可能错过一次唤醒，由超时兜底
+    bool ok = spaceCv.wait_for(lock, timeout, [&] {
+        return freeSpace() >= n || wakeGen.load() != gen;
+    });
+    writerWaiting = false;
+    return ok && freeSpace() >= n;
+}
+
+/* ---- 消费者 ---- */
+size_t PcmRing::Read(uint8_t* dst, size_t n, double* endPts)
+{
+    uint64_t r = readPos.load(std::memory_order_relaxed);
+    const uint64_t w = writePos.load(std::memory_order_acquire);
+
+    // 执行丢弃请求：直接跳过已写入的旧数据
+    const uint64_t d = std::min(discardPos.load(std::memory_order_acquire), w);
+    if (d > r) r = d;
+
+    n = std::min(n, static_cast<size_t>(w - r));
+    size_t off = static_cast<size_t>(r & mask);
+    size_t first = std::min(n, capacity - off);
+    memcpy(dst, buf + off, first);
+    memcpy(dst + first, buf, n - first);
+
+    const uint64_t end = r + n;
+    readPos.store(end, std::memory_order_release);
+
+    // 取出所有已被读过的标记，最后一个作为推算基准
+    const PtsMark* m;
+    while ((m = marks.Peek()) && m->pos <= end) {
+        marks.TryPop(anchor);
+        hasAnchor = true;
+    }
+
+    if (endPts) {
+        *endPts = hasAnchor && bytesPerSec > 0 ?
+                  anchor.pts + (end - anchor.pos) / bytesPerSec : -1.0;
+    }
+
+    if (writerWaiting.load(std::memory_order_relaxed)) spaceCv.notify_one();
+    return n;
+}
+
+/* ---- 任意线程 ---- */
+void PcmRing::DiscardWritten()
+{
+    // 只允许前移：seek 与解码线程可能同时请求
+    const uint64_t w = writePos.load(std::memory_order_acquire);
+    uint64_t cur = discardPos.load();
+    while (cur < w && !discardPos.compare_exchange_weak(cur, w)) {}
+}
+
+void PcmRing::WakeWriter()
+{
+    wakeGen.fetch_add(1);
+    std::lock_guard<std::mutex> lock(mtx);
+    spaceCv.notify_all();
+}
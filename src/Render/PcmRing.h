@@ -0,0 +1,78 @@
+#ifndef PCMRING_H
+#define PCMRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "SpscRing.h"
+
+// 音频解码线程（生产者）与 SDL 音频回调（消费者）之间的无锁 PCM 字节环形缓冲区。
+// 读写位置是单调递增的字节计数，回调中不加锁、不分配内存；
+// 生产者写入数据前用 Mark 记录该位置对应的 PTS，回调据此由已消费的字节数精确推算播放位置。
+class PcmRing {
+public:
+    PcmRing() = default;
+    ~PcmRing();
+
+    PcmRing(const PcmRing&) = delete;
+    PcmRing& operator=(const PcmRing&) = delete;
+
+    // capacity 向上取整为 2 的幂；bytesPerSec 用于把字节数换算为时间
+    bool Init(size_t capacity, int bytesPerSec);
+    void Destroy();
+
+    /* ---- 生产者 ---- */
+    // 记录下一个写入字节对应的 PTS（秒）
+    void   Mark(double pts);
+    // 写入尽可能多的数据，返回实际写入的字节数
+    size_t Write(const uint8_t* data, size_t n);
+    // 等待至少 n 字节的空闲空间；超时或被 WakeWriter 唤醒时返回 false
+    bool   WaitForSpace(size_t n, std::chrono::milliseconds timeout);
+
+    /* ---- 消费者（音频回调） ---- */
+    // 读出至多 n 字节，返回实际读出的字节数；endPts 为读出数据末尾的 PTS，未知时为 -1
+    size_t Read(uint8_t* dst, size_t n, double* endPts);
+
+    /* ---- 任意线程 ---- */
+    // 丢弃目前已写入的全部数据（由消费者在下一次 Read 时执行），用于 seek 和停止
+    void   DiscardWritten();
+    // 唤醒阻塞在 WaitForSpace 上的生产者
+    void   WakeWriter();
+
+    size_t Capacity() const { return capacity; }
+    size_t Buffered() const;
+
+private:
+    struct PtsMark {
+        uint64_t pos = 0;
+        double   pts = 0.0;
+    };
+
+    static constexpr size_t MAX_MARKS = 256;
+
+    size_t freeSpace() const;
+
+    uint8_t* buf = nullptr;
+    size_t   capacity = 0;
+    size_t   mask = 0;
+    double   bytesPerSec = 0.0;
+
+    alignas(64) std::atomic<uint64_t> readPos{0};   // 消费者写
+    alignas(64) std::atomic<uint64_t> writePos{0};  // 生产者写
+    alignas(64) std::atomic<uint64_t> discardPos{0};
+
+    SpscRing<PtsMark, MAX_MARKS> marks;
+    PtsMark anchor;          // 消费者持有：最近一个已读过的 PTS 标记
+    bool    hasAnchor = false;
+
+    // 只有生产者等待空间时回调才需要通知
+    std::mutex mtx;
+    std::condition_variable spaceCv;
+    std::atomic<bool>     writerWaiting{false};
+    std::atomic<uint32_t> wakeGen{0};
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef PIPELINETIMINGS_H
+#define PIPELINETIMINGS_H
+
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+// 流水线各阶段的耗时采样，供无窗口基准统计 p50/p99。
+// 每个阶段只由一个线程写入（解复用 / 视频解码 / 音频解码 / 消费者），读取发生在线程退出之后。
+struct StageSamples {
+    std::vector<double> micros;   // 每次操作耗时（微秒）
+    uint64_t bytes = 0;           // 处理的数据量
+    uint64_t count = 0;           // 操作次数
+
+    void Add(double us, uint64_t nbytes = 0)
+    {
+        micros.push_back(us);
+        bytes += nbytes;
+        count++;
+    }
+
+    double Percentile(double p) const
+    {
+        if (micros.empty()) return 0.0;
+        std::vector<double> sorted(micros);
+        size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+        return sorted[idx];
+    }
+
+    double TotalMicros() const
+    {
+        double total = 0.0;
+        for (double v : micros) total += v;
+        return total;
+    }
+
+    void Clear()
+    {
+        micros.clear();
+        bytes = 0;
+        count = 0;
+    }
+};
+
+struct PipelineTimings {
+    StageSamples input;        // 解复用器的 I/O 读取回调（自定义输入时）
+    StageSamples demux;        // av_read_frame
+    StageSamples videoDecode;  // 视频 send_packet + receive_frame（按包）
+    StageSamples audioDecode;  // 音频解码 + 重采样（按包）
+    StageSamples convert;      // processVideoFrame 中的平面拷贝 / sws_scale（按帧）
+    StageSamples queueWait;    // 帧在 vq 中停留的时间（按帧）
+
+    void Clear()
+    {
+        for (StageSamples* s : {&input, &demux, &videoDecode, &audioDecode, &convert, &queueWait}) s->Clear();
+    }
+};
+
+// 启动各阶段完成的时刻，相对启动起点（OpenMediaAsync / Initialize / LoadMedia 中最早的调用），单位毫秒
+struct StartupTimings {
+    double inputOpenedMs = 0.0;      // avformat_open_input 完成
+    double streamInfoMs = 0.0;       // 流信息就绪（find_stream_info 完成或跳过）
+    double glReadyMs = 0.0;          // SDL / GL / 着色器初始化完成（无窗口模式为 0）
+    double mediaLoadedMs = 0.0;      // 解码器打开，LoadMedia 返回
+    double firstFrameQueuedMs = 0.0; // 第一帧解码完成入队
+    double firstFrameShownMs = 0.0;  // 第一帧显示（无窗口模式为被消费的时刻）
+    bool   streamInfoSkipped = false;
+};
+
+// 固定桶宽的误差直方图（毫秒），超出范围的样本计入两端的桶。
+// 用于记录帧的实际显示时刻与其 PTS 之间的偏差，正值表示显示晚于 PTS。
+struct ErrorHistogram {
+    static constexpr double BUCKET_MS = 2.0;
+    static constexpr int    HALF_BUCKETS = 16;          // 覆盖 ±32ms
+    static constexpr int    BUCKETS = HALF_BUCKETS * 2 + 2;
+
+    uint64_t counts[BUCKETS] = {};
+    uint64_t total = 0;
+    double   sumAbs = 0.0;
+    double   maxAbs = 0.0;
+
+    void Add(double ms)
+    {
+        int idx = static_cast<int>(std::floor(ms / BUCKET_MS)) + HALF_BUCKETS + 1;
+        counts[std::clamp(idx, 0, BUCKETS - 1)]++;
+        total++;
+        sumAbs += std::abs(ms);
+        maxAbs = std::max(maxAbs, std::abs(ms));
+    }
+
+    // 第 i 个桶的下界（毫秒）；0 号与最后一个桶分别为下溢和上溢
+    static double BucketLow(int i) { return (i - HALF_BUCKETS - 1) * BUCKET_MS; }
+
+    void Clear() { *this = ErrorHistogram(); }
+};
+
+// 简单的微秒计时器
+class StageTimer {
+public:
+    StageTimer() : start(std::chrono::steady_clock::now()) {}
+    double ElapsedMicros() const
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
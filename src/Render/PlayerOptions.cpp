@@ -0,0 +1,84 @@
+#include "PlayerOptions.h"
+
+#include <cstring>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+const char* DecodeThreadTypeName(DecodeThreadType type)
+{
+    switch (type) {
+        case DecodeThreadType::Frame: return "frame";
+        case DecodeThreadType::Slice: return "slice";
+        default:                      return "auto";
+    }
+}
+
+bool ParseDecodeThreadType(const char* s, DecodeThreadType& type)
+{
+    if (std::strcmp(s, "auto") == 0)  { type = DecodeThreadType::Auto;  return true; }
+    if (std::strcmp(s, "frame") == 0) { type = DecodeThreadType::Frame; return true; }
+    if (std::strcmp(s, "slice") == 0) { type = DecodeThreadType::Slice; return true; }
+    return false;
+}
+
+int DecodeThreadTypeFlags(DecodeThreadType type)
+{
+    switch (type) {
+        case DecodeThreadType::Frame: return FF_THREAD_FRAME;
+        case DecodeThreadType::Slice: return FF_THREAD_SLICE;
+        default:                      return FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+}
+
+const char* InputModeName(InputMode mode)
+{
+    switch (mode) {
+        case InputMode::Mmap:      return "mmap";
+        case InputMode::ReadAhead: return "readahead";
+        default:                   return "default";
+    }
+}
+
+bool ParseInputMode(const char* s, InputMode& mode)
+{
+    if (std::strcmp(s, "default") == 0)   { mode = InputMode::Default;   return true; }
+    if (std::strcmp(s, "mmap") == 0)      { mode = InputMode::Mmap;      return true; }
+    if (std::strcmp(s, "readahead") == 0) { mode = InputMode::ReadAhead; return true; }
+    return false;
+}
+
+const char* SyncModeName(SyncMode mode)
+{
+    switch (mode) {
+        case SyncMode::Video:    return "video";
+        case SyncMode::External: return "external";
+        default:                 return "audio";
+    }
+}
+
+bool ParseSyncMode(const char* s, SyncMode& mode)
+{
+    if (std::strcmp(s, "audio") == 0)    { mode = SyncMode::Audio;    return true; }
+    if (std::strcmp(s, "video") == 0)    { mode = SyncMode::Video;    return true; }
+    if (std::strcmp(s, "external") == 0) { mode = SyncMode::External; return true; }
+    return false;
+}
+
+const char* TaskPriorityName(TaskPriority p)
+{
+    switch (p) {
+        case TaskPriority::High: return "high";
+        case TaskPriority::Low:  return "low";
+        default:                 return "normal";
+    }
+}
+
+bool ParseTaskPriority(const char* s, TaskPriority& p)
+{
+    if (std::strcmp(s, "high") == 0)   { p = TaskPriority::High;   return true; }
+    if (std::strcmp(s, "normal") == 0) { p = TaskPriority::Normal; return true; }
+    if (std::strcmp(s, "low") == 0)    { p = TaskPriority::Low;    return true; }
+    return false;
+}
@@ -0,0 +1,91 @@
+#ifndef PLAYEROPTIONS_H
+#define PLAYEROPTIONS_H
+
+#include <cstddef>
+#include <string>
+
+// 解码器多线程模式，对应 AVCodecContext::thread_type
+enum class DecodeThreadType {
+    Auto,   // 帧级 + 片级，由 FFmpeg 按编解码器能力选择
+    Frame,  // 仅帧级多线程（吞吐高，增加一帧/线程的延迟）
+    Slice   // 仅片级多线程（无额外延迟，依赖码流按 slice 编码）
+};
+
+// 解复用器的输入方式（MediaInput）
+enum class InputMode {
+    Default,    // avformat_open_input 自带的协议（本地文件为 file 协议的小块读取）
+    Mmap,       // 整个文件 mmap，按读取位置提前 madvise(WILLNEED)；不支持时退回 ReadAhead
+    ReadAhead   // 后台线程按大块顺序预读到环形窗口，解复用线程只从内存拷贝
+};
+
+// 主时钟（SyncClock）
+enum class SyncMode {
+    Audio,      // 视频跟随音频设备的播放位置；没有音频时退回 External
+    Video,      // 视频按自身 PTS 播放、不丢帧，解码跟不上时时钟等待视频；音频轻微变速跟随
+    External    // 单调时钟从第一帧开始推进，视频按它选帧/丢帧，音频轻微变速跟随
+};
+
+// 共享任务池（TaskScheduler）中的任务优先级：先执行高优先级的任务（包括从其他线程窃取），同优先级内本线程的任务优先
+enum class TaskPriority : int {
+    High = 0,     // 音频等对延迟敏感的阶段、前台会话
+    Normal = 1,
+    Low = 2       // 后台会话
+};
+
+// PlayerRender / MediaSession 的可调参数
+struct PlayerOptions {
+    int decodeThreads = 0;                                // 视频解码线程数，0 = 自动（按 CPU 核数）
+    DecodeThreadType decodeThreadType = DecodeThreadType::Auto;
+
+    // 共享任务池：解复用、视频解码 + 帧转换、音频解码 + 重采样以任务在进程共享的 TaskScheduler 中执行，
+    // 解码器的 slice 作业经 execute / execute2 也在其中执行（此时只用 slice 多线程）；多路同时播放时避免超额订阅
+    bool sharedPool = false;
+    TaskPriority taskPriority = TaskPriority::Normal;     // 本会话解复用与视频任务的优先级，音频任务总是 High
+
+    bool headless = false;        // 不创建窗口/GL 上下文/音频设备，解码结果直接丢弃（基准与 CI 使用）
+    bool disableAudio = false;    // 忽略音频流，不打开音频设备（多路画面中除第一路外的会话）
+    bool collectTimings = false;  // 记录各流水线阶段的耗时采样（PipelineTimings）
+    bool usePbo = true;           // 纹理经 PBO 环异步上传；false 时直接从内存指针上传
+    bool adaptiveSize = true;     // 窗口小于视频时按视口尺寸缩小解码输出（lowres / 转换阶段缩放）
+
+    // 快速启动：有界探测（容器头已给出解码参数时跳过 find_stream_info），第一帧不等音频缓冲即显示
+    bool fastStart = true;
+    long long probeSize = 2 * 1024 * 1024;     // fastStart 时的 probesize（字节）
+    long long analyzeDurationUs = 500000;      // fastStart 时的 analyzeduration（微秒）
+
+    SyncMode syncMode = SyncMode::Audio;
+
+    // 解码帧缓存（FrameCache）：播放头附近解码出的帧按 PTS 保留副本，逐帧后退和缓存范围内的 seek 不必重新解码。
+    // frameCacheMB 为内存预算（0 = 关闭，多路画面按路数平分）；frameCacheScale 为副本的缩小倍数；
+    // frameCacheYuv420 时副本统一存为 4:2:0（RGB24 / 4:4:4 源的副本减半）。
+    // 默认关闭：开启后解码阶段每帧一次分配和整帧拷贝 / 缩小，不再是零分配的稳态
+    size_t frameCacheMB = 0;
+    int frameCacheScale = 1;
+    bool frameCacheYuv420 = false;
+
+    InputMode inputMode = InputMode::ReadAhead;
+    size_t readAheadBytes = 32 * 1024 * 1024;   // 预读窗口（Mmap 模式下为 madvise 提前量）
+
+    // 运行指标（Metrics）常开；metricsFile 非空时每 metricsIntervalMs 追加一行 JSON 快照
+    std::string metricsFile;
+    int metricsIntervalMs = 1000;
+
+    // 热路径追踪（需以 ENABLE_TRACE 编译）：traceFile 非空时从 Play 开始记录，Stop 时写出 Chrome trace JSON
+    std::string traceFile;
+};
+
+const char* DecodeThreadTypeName(DecodeThreadType type);
+bool ParseDecodeThreadType(const char* s, DecodeThreadType& type);
+// 转换为 AVCodecContext::thread_type 所需的 FF_THREAD_* 标志
+int DecodeThreadTypeFlags(DecodeThreadType type);
+
+const char* InputModeName(InputMode mode);
+bool ParseInputMode(const char* s, InputMode& mode);
+
+const char* SyncModeName(SyncMode mode);
+bool ParseSyncMode(const char* s, SyncMode& mode);
+
+const char* TaskPriorityName(TaskPriority p);
+bool ParseTaskPriority(const char* s, TaskPriority& p);
+
+#endif
@@ -2,124 +2,61 @@
 #define PLAYERRENDER_H
 
 #include <SDL2/SDL.h>
-#include <glad/glad.h>
 #include <string>
-#include <queue>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <atomic>
-#include <climits>
-
-extern "C" {
-#include <libavcodec/avcodec.h>
-#include <libavformat/avformat.h>
-#include <libavutil/avutil.h>
-#include <libavutil/imgutils.h>
-#include <libswscale/swscale.h>
-#include <libswresample/swresample.h>
-}
-
-// 调试模式控制
-#ifdef ENABLE_DEBUG
-    #define DEBUG_ENABLED 1
-#else
-    #define DEBUG_ENABLED 1
-#endif
+#include "MediaSession.h"
+#include "RenderWindow.h"
+#include "FrameRenderer.h"
+#include "VideoTexture.h"
 
+// 单路播放器：一个窗口 + 一个 MediaSession。
+// 播放流水线（解复用、解码、同步）在 MediaSession 中，这里只负责窗口、事件、纹理上传与绘制
 class PlayerRender {
 public:
-    PlayerRender();
+    explicit PlayerRender(const PlayerOptions& options = PlayerOptions());
     ~PlayerRender();
 
     bool Initialize();
+    // 在后台线程打开解复用器（探测、流信息），与 Initialize 的窗口/GL 初始化并行；LoadMedia 等待其完成
+    void OpenMediaAsync(const std::string& file);
     bool LoadMedia(const std::string& file);
     void Play();
     void Pause();
     void Stop();
     void Seek(double seconds);
     void Run();
+    void RunHeadless();
     void CleanUp();
 
+    // 流水线阶段耗时（需开启 PlayerOptions::collectTimings，在 Stop 之后读取）
+    const PipelineTimings& Timings() const { return session.Timings(); }
+    InputStats IoStats() const { return session.IoStats(); }
+    const StartupTimings& Startup() const { return session.Startup(); }
+    InputMode  ActiveInputMode() const { return session.ActiveInputMode(); }
+    SyncMode   ActiveSyncMode() const { return session.ActiveSyncMode(); }
+    // 显示帧 PTS 相对音频时钟的误差（毫秒，正值为视频超前），每显示一帧记录一次；在渲染线程读取
+    const SyncErrorStats& SyncError() const { return session.SyncError(); }
+    // 常开的运行指标，可在任意线程读取快照
+    const MetricsRegistry& Metrics() const { return session.Metrics(); }
+    int VideoWidth()  const { return session.VideoWidth(); }
+    int VideoHeight() const { return session.VideoHeight(); }
+
 private:
     static constexpr int WIN_W = 1280;
     static constexpr int WIN_H = 720;
-    static constexpr int MAX_VQ = 48;
-    static constexpr int AUDIO_CACHE_MS = 1000;
-    static constexpr double SYNC_THRESHOLD = 0.03; // 30ms同步阈值
-    static constexpr double MAX_AHEAD = 0.1;       // 视频最大领先100ms
-    static constexpr double MAX_BEHIND = 0.5;      // 视频最大落后500ms
-    float aspectRatio = 16.0f/9.0f; // 默认 16 : 9
-
-    SDL_Window*   win = nullptr;
-    SDL_GLContext gl  = nullptr;
-    SDL_AudioDeviceID audioDev = 0;
-    int bytesPerSec = 0;
-
-    GLuint vao = 0, vbo = 0, ebo = 0, prog = 0, tex = 0;
-
-    AVFormatContext* fmt = nullptr;
-    AVCodecContext *vc = nullptr, *ac = nullptr;
-    SwsContext* sws = nullptr;
-    SwrContext* swr = nullptr;
-    AVPacket*  pkt = nullptr;
-    AVFrame *vf = nullptr, *af = nullptr;
-    int vIdx = -1, aIdx = -1;
-    int vw = 0, vh = 0;
-    double videoFPS = 25.0;
-
-    // 帧数据结构
-    struct FrameData {
-        int width = 0;
-        int height = 0;
-        uint8_t* data = nullptr;  // RGB24数据
-        double pts = -1.0;        // 时间戳
-    };
-
-    std::queue<FrameData> vq;
-    std::mutex   qMtx;
-    std::condition_variable qCv;
-    std::thread  decThread;
-    std::atomic<bool> playing{false}, paused{false}, stopReq{false};
-
-    std::atomic<double> audioWritePts{0.0};
-    std::atomic<bool>   audioReady{false};
-
-    uint8_t* vidBuf = nullptr;
-    uint8_t* audBuf = nullptr;
+    static constexpr double SEEK_STEP = 10.0;      // 左右方向键 seek 步长（秒）
 
-    // 调试统计信息
-    #if DEBUG_ENABLED
-    struct SyncStats {
-        double maxVideoLead = 0.0;    // 视频最大领先时间
-        double maxAudioLead = 0.0;    // 音频最大领先时间
-        double totalDiff = 0.0;       // 总时间差
-        int frameCount = 0;           // 已渲染帧数
-        int dropCount = 0;            // 丢弃帧数
-        int skipCount = 0;            // 跳帧数
-        int lateCount = 0;            // 延迟帧数
-    } syncStats;
+    PlayerOptions opts;
+    MediaSession  session;
 
-    bool debugOutput = false;         // 实时调试输出开关
-    #endif
+    RenderWindow  window;
+    FrameRenderer renderer;
+    VideoTexture  texture;
+    ViewRect      viewport;           // 按宽高比居中的视频区域（可绘制像素）
 
-    bool initSDL();
-    bool initGL();
-    bool initShaders();
-    bool openAudio(AVStream*);
-    bool openVideo(AVStream*);
-    GLuint compile(GLenum,const char*);
-    void   link(GLuint,GLuint);
-    void   decodeLoop();
-    double getAudioClock() const;
-    void   renderOne();
+    bool   renderOne();
     void   handleEvents(bool& running);
-    void processVideoFrame(AVFrame* frame);
-    #if DEBUG_ENABLED
-    void logDebug(const std::string& message) const;
-    void resetStats();
-    void printSyncStats() const;
-    #endif
+    void   updateViewport();
+    void   toggleTrace();
 };
 
 #endif
@@ -0,0 +1,364 @@
+#include "RawExport.h"
+#include "MediaSession.h"
+#include "ColorConvert.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+const char* RawFormatName(RawFormat f)
+{
+    switch (f) {
+        case RawFormat::Rgba:    return "rgba";
+        case RawFormat::Yuv420p: return "yuv420p";
+        default:                 return "rgb24";
+    }
+}
+
+bool ParseRawFormat(const char* s, RawFormat& f)
+{
+    if (std::strcmp(s, "rgb24") == 0)   { f = RawFormat::Rgb24;   return true; }
+    if (std::strcmp(s, "rgba") == 0)    { f = RawFormat::Rgba;    return true; }
+    if (std::strcmp(s, "yuv420p") == 0) { f = RawFormat::Yuv420p; return true; }
+    return false;
+}
+
+static AVPixelFormat rawPixelFormat(RawFormat f)
+{
+    switch (f) {
+        case RawFormat::Rgba:    return AV_PIX_FMT_RGBA;
+        case RawFormat::Yuv420p: return AV_PIX_FMT_YUV420P;
+        default:                 return AV_PIX_FMT_RGB24;
+    }
+}
+
+namespace {
+
+/* ========== 内存映射的输出文件 ========== */
+// 固定大小帧的数组。容量不足时加倍：扩展文件并重新映射，总共只有 O(log n) 次系统调用；
+// 帧直接转换到映射中，没有逐帧的 write，脏页由内核在后台写回。关闭时截断到实际写入的帧数。
+// 不支持 mmap 的平台退回带大缓冲的 fwrite
+class RawFrameFile {
+public:
+    static constexpr uint64_t INITIAL_FRAMES = 64;
+
+    RawFrameFile() = default;
+    ~RawFrameFile() { Close(); }
+
+    RawFrameFile(const RawFrameFile&) = delete;
+    RawFrameFile& operator=(const RawFrameFile&) = delete;
+
+    bool Open(const std::string& path, size_t bytesPerFrame);
+    // 下一帧的写入位置，Commit 之前有效；失败时返回 nullptr
+    uint8_t* NextFrame();
+    bool     Commit();
+    bool     Close();
+
+    uint64_t Frames() const { return frames; }
+    uint64_t Bytes() const { return frames * frameBytes; }
+    int      Remaps() const { return remaps; }
+
+private:
+    size_t   frameBytes = 0;
+    uint64_t frames = 0;
+    int      remaps = 0;
+
+#ifdef _WIN32
+    std::FILE* fp = nullptr;
+    std::vector<uint8_t> staging;
+#else
+    bool reserve(uint64_t capacityFrames);
+
+    int      fd = -1;
+    uint8_t* mapped = nullptr;
+    uint64_t capacity = 0;
+#endif
+};
+
+#ifdef _WIN32
+bool RawFrameFile::Open(const std::string& path, size_t bytesPerFrame)
+{
+    frameBytes = bytesPerFrame;
+    fp = std::fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    std::setvbuf(fp, nullptr, _IOFBF, 8 * 1024 * 1024);
+    staging.resize(frameBytes);
+    return true;
+}
+
+uint8_t* RawFrameFile::NextFrame()
+{
+    return fp ? staging.data() : nullptr;
+}
+
+bool RawFrameFile::Commit()
+{
+    if (std::fwrite(staging.data(), 1, frameBytes, fp) != frameBytes) return false;
+    frames++;
+    return true;
+}
+
+bool RawFrameFile::Close()
+{
+    if (!fp) return true;
+    bool ok = std::fclose(fp) == 0;
+    fp = nullptr;
+    return ok;
+}
+#else
+bool RawFrameFile::Open(const std::string& path, size_t bytesPerFrame)
+{
+    frameBytes = bytesPerFrame;
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    return reserve(INITIAL_FRAMES);
+}
+
+// 为 [from, to) 分配实际的磁盘块：稀疏文件在磁盘写满时，写映射页会触发 SIGBUS 而不是返回错误
+static bool allocateBlocks(int fd, size_t from, size_t to)
+{
+#ifdef __APPLE__
+    fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(to - from), 0};
+    if (fcntl(fd, F_PREALLOCATE, &store) == -1) return false;
+    return ftruncate(fd, static_cast<off_t>(to)) == 0;
+#else
+    return posix_fallocate(fd, static_cast<off_t>(from), static_cast<off_t>(to - from)) == 0;
+#endif
+}
+
+bool RawFrameFile::reserve(uint64_t capacityFrames)
+{
+    size_t oldBytes = static_cast<size_t>(capacity * frameBytes);
+    if (mapped) munmap(mapped, oldBytes);
+    mapped = nullptr;
+
+    size_t bytes = static_cast<size_t>(capacityFrames * frameBytes);
+    if (!allocateBlocks(fd, oldBytes, bytes)) return false;
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return false;
+
+    mapped = static_cast<uint8_t*>(p);
+    capacity = capacityFrames;
+    remaps++;
+    return true;
+}
+
+uint8_t* RawFrameFile::NextFrame()
+{
+    if (fd < 0) return nullptr;
+    if (frames == capacity && !reserve(capacity * 2)) return nullptr;
+    return mapped + frames * frameBytes;
+}
+
+bool RawFrameFile::Commit()
+{
+    frames++;
+    return true;
+}
+
+bool RawFrameFile::Close()
+{
+    if (fd < 0) return true;
+    if (mapped) munmap(mapped, capacity * frameBytes);
+    mapped = nullptr;
+    bool ok = ftruncate(fd, static_cast<off_t>(frames * frameBytes)) == 0;
+    ok = close(fd) == 0 && ok;
+    fd = -1;
+    return ok;
+}
+#endif
+
+/* ========== 帧转换 ========== */
+// 把会话取出的帧（YUV 路径为解码器输出帧的引用，回退路径为 RGB24）转换到输出格式并写入 dst。
+// RGBA 且不缩放时走 ColorConvert 的 SIMD 内核，其余经 sws_scale
+class ExportConverter {
+public:
+    ExportConverter(RawFormat format, int width, int height)
+        : format(format), dstFmt(rawPixelFormat(format)), outW(width), outH(height) {}
+    ~ExportConverter() { if (sws) sws_freeContext(sws); }
+
+    ExportConverter(const ExportConverter&) = delete;
+    ExportConverter& operator=(const ExportConverter&) = delete;
+
+    bool Convert(const FrameData& fd, uint8_t* dst);
+
+private:
+    RawFormat     format;
+    AVPixelFormat dstFmt;
+    int outW, outH;
+
+    SwsContext* sws = nullptr;
+    SwsContext* detailsFor = nullptr;    // 已设置色彩空间参数的上下文
+    int detailsCs = -1, detailsRange = -1;
+};
+
+bool ExportConverter::Convert(const FrameData& fd, uint8_t* dst)
+{
+    if (!fd.frame && fd.format != FrameFormat::RGB24) {
+        std::cerr << "Unexpected frame layout for export\n";
+        return false;
+    }
+    AVPixelFormat srcFmt = fd.frame ? static_cast<AVPixelFormat>(fd.frame->format) : AV_PIX_FMT_RGB24;
+
+    if (format == RawFormat::Rgba && fd.frame && fd.width == outW && fd.height == outH &&
+        ConvertFrameToRgba(fd.frame, dst, outW * 4)) {
+        return true;
+    }
+
+    sws = sws_getCachedContext(sws, fd.width, fd.height, srcFmt, outW, outH, dstFmt,
+                               SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!sws) {
+        std::cerr << "Failed to create SwsContext for " << av_get_pix_fmt_name(srcFmt)
+                  << " to " << RawFormatName(format) << "\n";
+        return false;
+    }
+
+    // YUV 转 RGB 按帧的色彩空间和范围（未标注时按高度猜测，与 GL 路径一致）
+    if (fd.frame && format != RawFormat::Yuv420p) {
+        int cs = fd.colorspace != AVCOL_SPC_UNSPECIFIED ? fd.colorspace
+               : fd.height >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+        int fullRange = fd.colorRange == AVCOL_RANGE_JPEG ? 1 : 0;
+        if (sws != detailsFor || cs != detailsCs || fullRange != detailsRange) {
+            sws_setColorspaceDetails(sws, sws_getCoefficients(cs), fullRange,
+                                     sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+            detailsFor = sws;
+            detailsCs = cs;
+            detailsRange = fullRange;
+        }
+    }
+
+    uint8_t* dstData[4] = {nullptr, nullptr, nullptr, nullptr};
+    int dstStride[4] = {0, 0, 0, 0};
+    av_image_fill_arrays(dstData, dstStride, dst, dstFmt, outW, outH, 1);
+    const uint8_t* const src[4] = {fd.planes[0], fd.planes[1], fd.planes[2], nullptr};
+    const int srcStride[4] = {fd.linesize[0], fd.linesize[1], fd.linesize[2], 0};
+    sws_scale(sws, src, srcStride, 0, fd.height, dstData, dstStride);
+    return true;
+}
+
+} // namespace
+
+/* ========== 导出 ========== */
+int RunRawExport(const std::string& file, const RawExportOptions& options, const PlayerOptions& player)
+{
+    if (options.output.empty()) {
+        std::cerr << "No export output file given\n";
+        return 1;
+    }
+
+    // 无窗口、无音频：不做音画同步也不丢迟到帧，解码线程按最快速度产出
+    PlayerOptions o = player;
+    o.headless = true;
+    o.disableAudio = true;
+    MediaSession session(o);
+    if (!session.LoadMedia(file)) {
+        std::cerr << "Failed to load " << file << "\n";
+        return 1;
+    }
+
+    // 输出尺寸：只给一边时按宽高比推算另一边；4:2:0 输出取偶数
+    int srcW = session.VideoWidth(), srcH = session.VideoHeight();
+    int outW = options.width, outH = options.height;
+    if (outW <= 0 && outH <= 0) {
+        outW = srcW;
+        outH = srcH;
+    } else if (outW <= 0) {
+        outW = static_cast<int>(std::lround(static_cast<double>(outH) * srcW / srcH));
+    } else if (outH <= 0) {
+        outH = static_cast<int>(std::lround(static_cast<double>(outW) * srcH / srcW));
+    }
+    if (options.format == RawFormat::Yuv420p) {
+        outW = (outW + 1) & ~1;
+        outH = (outH + 1) & ~1;
+    }
+    outW = std::max(outW, 2);
+    outH = std::max(outH, 2);
+
+    int frameBytes = av_image_get_buffer_size(rawPixelFormat(options.format), outW, outH, 1);
+    if (frameBytes <= 0) {
+        std::cerr << "Invalid export size " << outW << "x" << outH << "\n";
+        return 1;
+    }
+
+    RawFrameFile out;
+    if (!out.Open(options.output, static_cast<size_t>(frameBytes))) {
+        std::cerr << "Failed to open export output: " << options.output << "\n";
+        return 1;
+    }
+    std::ofstream index(options.output + ".pts");
+    if (!index) {
+        std::cerr << "Failed to open PTS index: " << options.output << ".pts\n";
+        return 1;
+    }
+    index << "# " << RawFormatName(options.format) << " " << outW << "x" << outH
+          << " frame_bytes=" << frameBytes << " stride=" << options.stride << " source=" << file << "\n";
+    index << std::fixed << std::setprecision(6);
+
+    std::cout << "Exporting " << file << " -> " << options.output << " (" << RawFormatName(options.format)
+              << " " << outW << "x" << outH << ", every " << std::max(1, options.stride) << " frame(s))\n";
+
+    // 转换和写入在消费线程上进行，与解码线程并行；帧出队后解码线程即可继续
+    ExportConverter converter(options.format, outW, outH);
+    const uint64_t stride = static_cast<uint64_t>(std::max(1, options.stride));
+    uint64_t decoded = 0;
+    bool failed = false;
+    StageTimer convertTimer;
+    double convertSeconds = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+    session.Play();
+    session.RunHeadless([&](const FrameData& fd) {
+        uint64_t n = decoded++;
+        if (n % stride != 0) return true;
+
+        convertTimer = StageTimer();
+        uint8_t* dst = out.NextFrame();
+        if (!dst || !converter.Convert(fd, dst)) {
+            if (!dst) std::cerr << "Failed to grow export output (disk full?)\n";
+            failed = true;
+            return false;
+        }
+        index << out.Frames() << " " << n << " " << fd.pts << "\n";
+        if (!out.Commit()) {
+            std::cerr << "Failed to write export output\n";
+            failed = true;
+            return false;
+        }
+        convertSeconds += convertTimer.ElapsedMicros() / 1e6;
+        return true;
+    });
+    session.Stop();
+
+    bool closed = out.Close();
+    index.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!closed || !index) {
+        std::cerr << "Failed to finish export output\n";
+        failed = true;
+    }
+
+    double mb = out.Bytes() / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(1)
+              << "Exported " << out.Frames() << " of " << decoded << " decoded frames, " << mb << " MB in "
+              << seconds << " s (" << (seconds > 0 ? decoded / seconds : 0.0) << " decoded fps, "
+              << (seconds > 0 ? mb / seconds : 0.0) << " MB/s, convert " << convertSeconds << " s, "
+              << out.Remaps() << " mappings)\n";
+    session.CleanUp();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+#ifndef RAWEXPORT_H
+#define RAWEXPORT_H
+
+#include <string>
+#include "PlayerOptions.h"
+
+// 原始帧导出的像素格式（紧凑排列，无行对齐）
+enum class RawFormat : int {
+    Rgb24,
+    Rgba,
+    Yuv420p      // I420：Y 平面后接 U、V 平面
+};
+
+const char* RawFormatName(RawFormat f);
+bool ParseRawFormat(const char* s, RawFormat& f);
+
+struct RawExportOptions {
+    std::string output;              // 原始帧文件；PTS 索引写到 output + ".pts"
+    RawFormat format = RawFormat::Rgb24;
+    int width = 0, height = 0;       // 输出尺寸，0 = 源尺寸；只给一边时按宽高比推算另一边
+    int stride = 1;                  // 每 stride 帧导出一帧（全部帧仍需解码）
+};
+
+// 非交互的批量导出：复用 MediaSession 的解复用 / 解码流水线（无窗口、无音频），不做音画同步，
+// 以解码能达到的最快速度把每一帧转换后写入内存映射的输出文件。
+// 输出文件是固定大小帧的连续数组（第 i 帧位于 i * frameBytes），PTS 索引为文本，每行
+// "<导出序号> <源帧序号> <pts 秒>"，首行以 # 开头记录格式、尺寸和帧字节数。
+// player 中的解码线程数、输入模式、共享任务池等设置照常生效。返回 0 表示成功。
+int RunRawExport(const std::string& file, const RawExportOptions& options,
+                 const PlayerOptions& player = PlayerOptions());
+
+#endif
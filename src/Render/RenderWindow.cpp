@@ -0,0 +1,165 @@
+#include "RenderWindow.h"
+#include "PipelineTimings.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+bool RenderWindow::Create(const char* title, int w, int h)
+{
+    Destroy();
+
+    // 按窗口引用计数：最后一个窗口销毁时才关闭视频子系统
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_InitSubSystem(VIDEO) Error: " << SDL_GetError() << "\n";
+        return false;
+    }
+    videoSubsystem = true;
+
+    // 设置OpenGL属性
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+    // 创建窗口
+    win = SDL_CreateWindow(title,
+                           SDL_WINDOWPOS_CENTERED,
+                           SDL_WINDOWPOS_CENTERED,
+                           w, h,
+                           SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_SHOWN);
+    if (!win) {
+        std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << "\n";
+        Destroy();
+        return false;
+    }
+
+    // 创建OpenGL上下文
+    gl = SDL_GL_CreateContext(win);
+    if (!gl) {
+        std::cerr << "SDL_GL_CreateContext Error: " << SDL_GetError() << "\n";
+        Destroy();
+        return false;
+    }
+
+    // 设置垂直同步
+    // 优先尝试自适应 VSync
+    vsyncEnabled = true;
+    if (SDL_GL_SetSwapInterval(-1) == 0) {
+        printf("Adaptive VSync supported.\n");
+    } else if (SDL_GL_SetSwapInterval(1) == 0) {
+        printf("Normal VSync supported.\n");
+    } else {
+        printf("VSync not supported, disabling VSync.\n");
+        // 彻底关闭 VSync
+        SDL_GL_SetSwapInterval(0);
+        vsyncEnabled = false;
+    }
+
+    // 刷新周期初值取自显示模式，播放中再由实际 swap 间隔校正
+    SDL_DisplayMode mode;
+    if (SDL_GetWindowDisplayMode(win, &mode) == 0 && mode.refresh_rate > 0) {
+        vsyncPeriod = 1.0 / mode.refresh_rate;
+    }
+    printf("Display refresh: %.2f Hz\n", 1.0 / vsyncPeriod);
+
+    // 加载GLAD（函数指针为进程内共享，多个上下文重复加载得到同样的结果）
+    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        Destroy();
+        return false;
+    }
+
+    lastSwap = Clock::now();
+    return true;
+}
+
+void RenderWindow::Destroy()
+{
+    if (gl) SDL_GL_DeleteContext(gl);
+    if (win) SDL_DestroyWindow(win);
+    gl = nullptr;
+    win = nullptr;
+
+    if (videoSubsystem) {
+        SDL_QuitSubSystem(SDL_INIT_VIDEO);
+        videoSubsystem = false;
+    }
+}
+
+void RenderWindow::MakeCurrent()
+{
+    if (win && gl) SDL_GL_MakeCurrent(win, gl);
+}
+
+bool RenderWindow::Owns(const SDL_Event& event) const
+{
+    Uint32 id = 0;
+    switch (event.type) {
+        case SDL_WINDOWEVENT: id = event.window.windowID; break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:       id = event.key.windowID; break;
+        default:              return true;
+    }
+    return win && id == SDL_GetWindowID(win);
+}
+
+void RenderWindow::SetTitle(const std::string& title)
+{
+    if (win) SDL_SetWindowTitle(win, title.c_str());
+}
+
+void RenderWindow::DrawableSize(int& w, int& h) const
+{
+    w = h = 0;
+    if (win) SDL_GL_GetDrawableSize(win, &w, &h);
+}
+
+bool RenderWindow::DisplaySize(int& w, int& h) const
+{
+    if (!win) return false;
+
+    SDL_Rect bounds;
+    int display = SDL_GetWindowDisplayIndex(win);
+    if (display < 0 || SDL_GetDisplayBounds(display, &bounds) != 0) return false;
+
+    int ww = 0, wh = 0, dw = 0, dh = 0;
+    SDL_GetWindowSize(win, &ww, &wh);
+    SDL_GL_GetDrawableSize(win, &dw, &dh);
+    w = (ww > 0 && dw > 0) ? bounds.w * dw / ww : bounds.w;
+    h = (wh > 0 && dh > 0) ? bounds.h * dh / wh : bounds.h;
+    return w > 0 && h > 0;
+}
+
+RenderWindow::Clock::time_point RenderWindow::NextVsync(Clock::time_point now) const
+{
+    auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(vsyncPeriod));
+    return std::max(lastSwap + period, now);
+}
+
+double RenderWindow::Swap()
+{
+    StageTimer swapTimer;
+    {
+        TRACE_SCOPE("SDL_GL_SwapWindow");
+        SDL_GL_SwapWindow(win);
+    }
+    double swapUs = swapTimer.ElapsedMicros();
+
+    auto now = Clock::now();
+    double interval = std::chrono::duration<double>(now - lastSwap).count();
+    lastSwap = now;
+
+    // 用实际 swap 间隔平滑校正刷新周期，丢掉卡顿或跨多个 vsync 的样本
+    if (vsyncEnabled && interval > vsyncPeriod * 0.5 && interval < vsyncPeriod * 1.5) {
+        vsyncPeriod += (interval - vsyncPeriod) * 0.05;
+    }
+    return swapUs;
+}
+
+void RenderWindow::WaitNextPeriod() const
+{
+    if (vsyncEnabled) return;
+    std::this_thread::sleep_until(lastSwap + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(vsyncPeriod)));
+}
@@ -0,0 +1,59 @@
+#ifndef RENDERWINDOW_H
+#define RENDERWINDOW_H
+
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+#include <chrono>
+#include <string>
+
+// 一个 SDL 窗口及其 OpenGL 3.3 core 上下文，以及按 swap 间隔校正的 vsync 节拍。
+// SDL 视频子系统按窗口引用计数初始化/释放（SDL_InitSubSystem / SDL_QuitSubSystem），
+// 同一进程可以有多个窗口；所有方法只能在创建窗口的线程调用
+class RenderWindow {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    RenderWindow() = default;
+    ~RenderWindow() { Destroy(); }
+
+    RenderWindow(const RenderWindow&) = delete;
+    RenderWindow& operator=(const RenderWindow&) = delete;
+
+    bool Create(const char* title, int w, int h);
+    void Destroy();
+    bool Valid() const { return win != nullptr; }
+
+    // 多个窗口时，绘制前切换到本窗口的上下文
+    void MakeCurrent();
+    // 事件属于本窗口（或不属于任何窗口，如 SDL_QUIT）
+    bool Owns(const SDL_Event& event) const;
+    void SetTitle(const std::string& title);
+
+    // 可绘制区域（高 DPI 下大于窗口逻辑尺寸）
+    void DrawableSize(int& w, int& h) const;
+    // 当前显示器能容纳的最大可绘制区域
+    bool DisplaySize(int& w, int& h) const;
+
+    // ===== vsync 节拍 =====
+    bool   VsyncEnabled() const { return vsyncEnabled; }
+    double VsyncPeriod() const { return vsyncPeriod; }
+    // 预测的下一次 vsync 显示时刻（不早于 now）
+    Clock::time_point NextVsync(Clock::time_point now) const;
+    // 开始计时（进入主循环时调用）
+    void ResetSwapClock() { lastSwap = Clock::now(); }
+    // SwapWindow 并用实际间隔校正刷新周期；返回 SwapWindow 的耗时（微秒）
+    double Swap();
+    // 没有 vsync 时按刷新周期休眠，避免空转
+    void WaitNextPeriod() const;
+
+private:
+    SDL_Window*   win = nullptr;
+    SDL_GLContext gl  = nullptr;
+    bool videoSubsystem = false;
+
+    bool   vsyncEnabled = false;
+    double vsyncPeriod = 1.0 / 60.0;              // 刷新周期（秒），由 swap 间隔校正
+    Clock::time_point lastSwap;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+
+// 有界单生产者/单消费者无锁环形队列。
+// 生产者只写 tail，消费者只写 head，两者通过 acquire/release 同步；
+// head、tail 及各自缓存的对端位置分别独占缓存行，避免伪共享。
+// TryPush 只能在生产者线程调用，TryPop/Peek 只能在消费者线程调用，Size/Empty 任意线程可读（近似值）。
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0, "SpscRing capacity must be positive");
+
+public:
+    static constexpr size_t CACHE_LINE = 64;
+
+    bool TryPush(const T& value)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == Capacity) return false; // 满
+        }
+        slots[t % Capacity] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& out)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false; // 空
+        }
+        out = slots[h % Capacity];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 查看队首元素但不出队，返回的指针在下一次 TryPop 之前有效
+    const T* Peek()
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return nullptr;
+        }
+        return &slots[h % Capacity];
+    }
+
+    size_t Size() const
+    {
+        const size_t h = head.load(std::memory_order_acquire);
+        const size_t t = tail.load(std::memory_order_acquire);
+        return t >= h ? t - h : 0;
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    // 消费者拥有
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+
+    // 生产者拥有
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+
+    alignas(CACHE_LINE) T slots[Capacity];
+};
+
+#endif
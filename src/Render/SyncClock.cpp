@@ -0,0 +1,94 @@
+#include "SyncClock.h"
+#include <algorithm>
+
+/* ---- MediaClock ---- */
+void MediaClock::Set(double pts, Time at)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    anchorPts = pts;
+    anchorAt = at;
+    valid = true;
+}
+
+void MediaClock::Invalidate()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    valid = false;
+}
+
+bool MediaClock::Valid() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return valid;
+}
+
+double MediaClock::Get(Time now) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return valid ? valueLocked(now) : NAN;
+}
+
+double MediaClock::valueLocked(Time now) const
+{
+    if (paused) return anchorPts;
+    return anchorPts + std::chrono::duration<double>(now - anchorAt).count() * speed;
+}
+
+void MediaClock::SetPaused(bool p, Time now)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (p == paused) return;
+    if (valid) anchorPts = valueLocked(now);
+    anchorAt = now;
+    paused = p;
+}
+
+void MediaClock::SetSpeed(double s, Time now)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    // 先按旧速度折算到当前时刻，避免改速度时时钟跳变
+    if (valid) anchorPts = valueLocked(now);
+    anchorAt = now;
+    speed = s;
+}
+
+/* ---- 主时钟选择 ---- */
+SyncMode ResolveSyncMode(SyncMode requested, bool hasAudio)
+{
+    if (requested == SyncMode::Audio && !hasAudio) return SyncMode::External;
+    return requested;
+}
+
+/* ---- AudioDriftCorrector ---- */
+void AudioDriftCorrector::Reset()
+{
+    cum = 0.0;
+    avgDiff = 0.0;
+    count = 0;
+}
+
+int AudioDriftCorrector::WantedSamples(int nbSamples, double diff, int sampleRate)
+{
+    // 偏差过大（seek、时钟刚建立）时重新开始统计，交给丢帧/重建时钟处理
+    if (std::isnan(diff) || std::abs(diff) >= NOSYNC_THRESHOLD) {
+        Reset();
+        return nbSamples;
+    }
+
+    // 指数平均：系数使 AVG_FRAMES 帧之前的样本权重衰减到 1%
+    static const double coef = std::exp(std::log(0.01) / AVG_FRAMES);
+    cum = diff + coef * cum;
+    if (count < AVG_FRAMES) {
+        count++;
+        return nbSamples;
+    }
+
+    avgDiff = cum * (1.0 - coef);
+    if (std::abs(avgDiff) < threshold) return nbSamples;
+
+    // 音频超前：多输出样本（放慢）；音频落后：少输出样本（加快）
+    int wanted = nbSamples + static_cast<int>(diff * sampleRate);
+    int minSamples = static_cast<int>(nbSamples * (1.0 - MAX_CORRECTION));
+    int maxSamples = static_cast<int>(nbSamples * (1.0 + MAX_CORRECTION));
+    return std::clamp(wanted, minSamples, maxSamples);
+}
@@ -0,0 +1,88 @@
+#ifndef SYNCCLOCK_H
+#define SYNCCLOCK_H
+
+#include <chrono>
+#include <mutex>
+#include <cmath>
+#include <cstdint>
+#include "PipelineTimings.h"
+#include "PlayerOptions.h"
+
+// 播放时钟：anchorAt 时刻对应 anchorPts，之后按 speed 随单调时钟推进，暂停时冻结。
+// 渲染线程建立/暂停，解码线程与音频解码线程读取，内部加锁
+class MediaClock {
+public:
+    using Time = std::chrono::steady_clock::time_point;
+
+    void   Set(double pts, Time at);
+    void   Invalidate();
+    bool   Valid() const;
+    // 未建立时返回 NAN
+    double Get(Time now) const;
+    // 暂停时把当前值固定为新的起点，恢复后从恢复时刻继续推进
+    void   SetPaused(bool paused, Time now);
+    void   SetSpeed(double speed, Time now);
+
+private:
+    double valueLocked(Time now) const;
+
+    mutable std::mutex mtx;
+    bool   valid = false;
+    bool   paused = false;
+    double anchorPts = 0.0;
+    double speed = 1.0;
+    Time   anchorAt;
+};
+
+// 实际使用的主时钟：请求音频主时钟但没有可用的音频输出时退回外部时钟
+SyncMode ResolveSyncMode(SyncMode requested, bool hasAudio);
+
+// 音频跟随非音频主时钟时的漂移校正（音频解码线程独占）。
+// 对音频时钟与主时钟之差做指数平均，平均偏差超过阈值后按比例增减本帧的输出样本数，
+// 由 swr_set_compensation 轻微变速完成，单帧调整不超过 MAX_CORRECTION
+class AudioDriftCorrector {
+public:
+    static constexpr double MAX_CORRECTION = 0.10;   // 单帧样本数最多增减 10%
+    static constexpr double NOSYNC_THRESHOLD = 10.0; // 偏差超过该值（秒）视为时钟跳变，不做校正
+    static constexpr int    AVG_FRAMES = 20;         // 指数平均的有效帧数
+
+    explicit AudioDriftCorrector(double threshold = 0.03) : threshold(threshold) {}
+
+    void Reset();
+    // diff = 音频时钟 - 主时钟（秒，正值为音频超前）；返回本帧期望输出的样本数（输入采样率下）
+    int  WantedSamples(int nbSamples, double diff, int sampleRate);
+    double AverageDiff() const { return avgDiff; }
+
+private:
+    double threshold;
+    double cum = 0.0;
+    double avgDiff = 0.0;
+    int    count = 0;
+};
+
+// 连续的同步误差统计（毫秒）：Welford 均值/标准差、反映当前状态的指数滑动平均、分布直方图
+struct SyncErrorStats {
+    static constexpr double EWMA_ALPHA = 0.05;
+
+    uint64_t count = 0;
+    double   mean = 0.0;
+    double   m2 = 0.0;
+    double   ewma = 0.0;
+    ErrorHistogram hist;
+
+    void Add(double ms)
+    {
+        count++;
+        double delta = ms - mean;
+        mean += delta / count;
+        m2 += delta * (ms - mean);
+        ewma = count == 1 ? ms : ewma + (ms - ewma) * EWMA_ALPHA;
+        hist.Add(ms);
+    }
+
+    double StdDev() const { return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0; }
+
+    void Clear() { *this = SyncErrorStats(); }
+};
+
+#endif
@@ -0,0 +1,279 @@
+#include "TaskScheduler.h"
+#include "Trace.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+// 当前线程在线程池中的序号（非工作线程为 -1）与正在执行的任务优先级
+thread_local int tlsWorker = -1;
+thread_local TaskPriority tlsPriority = TaskPriority::Normal;
+}
+
+TaskPriority TaskScheduler::CurrentPriority()
+{
+    return tlsPriority;
+}
+
+void TaskScheduler::SetThreadPriority(TaskPriority prio)
+{
+    tlsPriority = prio;
+}
+
+/* ---- 启动与关闭 ---- */
+void TaskScheduler::Start(int count)
+{
+    std::lock_guard<std::mutex> lock(startMtx);
+    if (workerCount.load() > 0) return;
+
+    if (count <= 0) count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    stopping = false;
+    workers.clear();
+    for (int i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    statsSince.store(Clock::now().time_since_epoch().count());
+    // 工作线程启动前 workers 已完整构造，之后不再改变，直到 Shutdown
+    workerCount.store(count, std::memory_order_release);
+    for (int i = 0; i < count; ++i) {
+        workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+    }
+    std::cout << "Task scheduler: " << count << " workers\n";
+}
+
+void TaskScheduler::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(startMtx);
+    if (workerCount.load() == 0) return;
+
+    {
+        std::lock_guard<std::mutex> sleepLock(sleepMtx);
+        stopping = true;
+    }
+    sleepCv.notify_all();
+    for (auto& w : workers) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+
+    // 未执行的任务直接丢弃（提交方应在关闭前等待自己的任务完成）
+    workerCount.store(0, std::memory_order_release);
+    workers.clear();
+    std::lock_guard<std::mutex> injectLock(injectMtx);
+    for (auto& q : injected) q.clear();
+    pending = 0;
+}
+
+/* ---- 提交 ---- */
+void TaskScheduler::Submit(std::function<void()> fn, TaskPriority prio)
+{
+    if (WorkerCount() == 0) Start();
+
+    Task task{std::move(fn), prio, Clock::now()};
+    int p = static_cast<int>(prio);
+    if (tlsWorker >= 0) {
+        Worker& w = *workers[tlsWorker];
+        std::lock_guard<std::mutex> lock(w.mtx);
+        w.q[p].push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injectMtx);
+        injected[p].push_back(std::move(task));
+    }
+    pending.fetch_add(1);
+
+    // 有空闲线程时唤醒一个；在锁内检查等待条件，不会丢失唤醒
+    if (sleeping.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMtx); }
+        sleepCv.notify_one();
+    }
+}
+
+/* ---- 工作线程 ---- */
+void TaskScheduler::workerLoop(int index)
+{
+    tlsWorker = index;
+    TRACE_THREAD_NAME("task-worker");
+
+    Task task;
+    while (true) {
+        if (takeTask(index, task)) {
+            runTask(index, task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMtx);
+        if (stopping) break;
+        sleeping.fetch_add(1);
+        sleepCv.wait(lock, [this] { return stopping || pending.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stopping) break;
+    }
+    tlsWorker = -1;
+}
+
+// 按优先级从高到低：本线程队列尾部、注入队列、其他线程队列头部
+bool TaskScheduler::takeTask(int self, Task& task)
+{
+    if (pending.load() == 0) return false;
+    for (int p = 0; p < PRIORITIES; ++p) {
+        if (popOwn(self, p, task) || popInjected(p, task)) {
+            pending.fetch_sub(1);
+            return true;
+        }
+        if (steal(self, p, task)) {
+            pending.fetch_sub(1);
+            metrics.steals.Add();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::popOwn(int self, int prio, Task& task)
+{
+    Worker& w = *workers[self];
+    std::lock_guard<std::mutex> lock(w.mtx);
+    if (w.q[prio].empty()) return false;
+    task = std::move(w.q[prio].back());
+    w.q[prio].pop_back();
+    return true;
+}
+
+bool TaskScheduler::popInjected(int prio, Task& task)
+{
+    std::lock_guard<std::mutex> lock(injectMtx);
+    if (injected[prio].empty()) return false;
+    task = std::move(injected[prio].front());
+    injected[prio].pop_front();
+    return true;
+}
+
+bool TaskScheduler::steal(int self, int prio, Task& task)
+{
+    // 从下一个线程开始轮询，避免所有线程同时争抢同一个受害者
+    int n = WorkerCount();
+    for (int k = 1; k < n; ++k) {
+        Worker& w = *workers[(self + k) % n];
+        std::lock_guard<std::mutex> lock(w.mtx);
+        if (w.q[prio].empty()) continue;
+        task = std::move(w.q[prio].front());
+        w.q[prio].pop_front();
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::runTask(int self, Task& task)
+{
+    auto start = Clock::now();
+    metrics.Queue(task.prio).RecordMicros(std::chrono::duration<double, std::micro>(start - task.queuedAt).count());
+
+    tlsPriority = task.prio;
+    task.fn();
+    task.fn = nullptr;   // 在计时内释放捕获的状态
+    tlsPriority = TaskPriority::Normal;
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    workers[self]->busyNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+    metrics.run.Record(static_cast<uint64_t>(ns));
+    metrics.tasks.Add();
+}
+
+/* ---- 并行作业 ---- */
+void TaskScheduler::ParallelFor(int count, int maxParallel, TaskPriority prio,
+                                const std::function<void(int, int)>& fn)
+{
+    if (count <= 0) return;
+    if (WorkerCount() == 0) Start();
+    metrics.parallelJobs.Add(static_cast<uint64_t>(count));
+
+    // 参与者：调用线程 + helpers 个任务，总数不超过作业数、maxParallel 和工作线程数 + 1
+    int helpers = std::min({count, std::max(1, maxParallel), WorkerCount() + 1}) - 1;
+    if (helpers <= 0) {
+        for (int i = 0; i < count; ++i) fn(i, 0);
+        return;
+    }
+
+    // 批次状态由 helper 任务共享持有：批次完成后才开始执行的 helper 只会看到作业已取完
+    struct Batch {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        int count = 0;
+        const std::function<void(int, int)>* fn = nullptr;
+        std::mutex mtx;
+        std::condition_variable cv;
+
+        void Work(int slot)
+        {
+            int i;
+            while ((i = next.fetch_add(1)) < count) {
+                (*fn)(i, slot);
+                if (done.fetch_add(1) + 1 == count) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    cv.notify_all();
+                }
+            }
+        }
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->count = count;
+    batch->fn = &fn;
+
+    for (int slot = 1; slot <= helpers; ++slot) {
+        Submit([batch, slot] { batch->Work(slot); }, prio);
+    }
+    batch->Work(0);
+
+    // 作业已全部被取走，只需等待其他参与者手中正在执行的作业
+    std::unique_lock<std::mutex> lock(batch->mtx);
+    batch->cv.wait(lock, [&] { return batch->done.load() == count; });
+}
+
+/* ---- 统计 ---- */
+double TaskScheduler::WorkerUtilization(int index) const
+{
+    if (index < 0 || index >= WorkerCount()) return 0.0;
+    double wall = std::chrono::duration<double, std::nano>(
+        Clock::now() - Clock::time_point(Clock::duration(statsSince.load()))).count();
+    return wall > 0.0 ? std::min(1.0, workers[index]->busyNs.load() / wall) : 0.0;
+}
+
+double TaskScheduler::Utilization() const
+{
+    int n = WorkerCount();
+    if (n == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) sum += WorkerUtilization(i);
+    return sum / n;
+}
+
+void TaskScheduler::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(startMtx);
+    for (auto& w : workers) w->busyNs.store(0);
+    statsSince.store(Clock::now().time_since_epoch().count());
+    metrics.registry.Reset();
+}
+
+void TaskScheduler::PrintStats() const
+{
+    int n = WorkerCount();
+    if (n == 0) return;
+
+    std::cout << "\n===== 共享任务池 =====\n";
+    std::cout << "工作线程: " << n << ", 利用率 " << std::fixed << std::setprecision(1)
+              << Utilization() * 100.0 << "% (";
+    for (int i = 0; i < n; ++i) {
+        std::cout << (i ? " " : "") << static_cast<int>(WorkerUtilization(i) * 100.0 + 0.5);
+    }
+    std::cout << ")\n";
+    std::cout << "任务: " << metrics.tasks.Value() << ", 窃取 " << metrics.steals.Value()
+              << ", 并行作业 " << metrics.parallelJobs.Value() << "\n";
+    for (const LatencyHistogram* h : {&metrics.queueHigh, &metrics.queueNormal, &metrics.queueLow, &metrics.run}) {
+        HistogramSnapshot snap = h->Snapshot();
+        if (snap.count == 0) continue;
+        std::cout << std::left << std::setw(18) << h->Name() << std::right << " " << snap.count
+                  << " 次, 平均 " << snap.MeanMicros() << " us, p50 " << snap.PercentileMicros(0.50)
+                  << " us, p99 " << snap.PercentileMicros(0.99) << " us, 最大 " << snap.MaxMicros() << " us\n";
+    }
+    std::cout << "======================\n";
+}
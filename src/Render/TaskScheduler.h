@@ -0,0 +1,122 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Metrics.h"
+#include "PlayerOptions.h"
+
+// 进程内共享的工作窃取线程池。多个 MediaSession 的流水线阶段（解复用、解码、重采样）以任务提交，
+// FFmpeg 解码器的 execute / execute2 也由 ParallelFor 在这里执行，全部 CPU 工作共用按核数创建的工作线程，
+// 不再是 N 路 × (流水线线程 + 解码器线程) 的超额订阅。
+//
+// - 每个工作线程每个优先级一个双端队列：本线程从尾部取（LIFO，缓存友好），其他线程从头部窃取；
+// - 非工作线程提交的任务进入共享的注入队列；
+// - 任务不应长时间阻塞：阻塞会占住一个工作线程。
+// 第一次提交时按 CPU 核数启动（或先调用 Start 指定线程数）。
+class TaskScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int PRIORITIES = 3;
+
+    static TaskScheduler& Instance()
+    {
+        static TaskScheduler scheduler;
+        return scheduler;
+    }
+
+    // 启动 workers 个工作线程（0 = CPU 核数）；已启动时不做任何事
+    void Start(int workers = 0);
+    void Shutdown();
+    int  WorkerCount() const { return workerCount.load(std::memory_order_acquire); }
+
+    void Submit(std::function<void()> task, TaskPriority prio = TaskPriority::Normal);
+
+    // 把 [0, count) 的作业分给至多 maxParallel 个参与者并等待全部完成；调用线程也是参与者（slot 0），
+    // 在工作线程中调用不会死锁。fn(job, slot) 中 slot 在同一批内唯一且小于 maxParallel
+    void ParallelFor(int count, int maxParallel, TaskPriority prio,
+                     const std::function<void(int job, int slot)>& fn);
+
+    // 当前线程正在执行的任务的优先级（非工作线程为 SetThreadPriority 设置的值，默认 Normal）
+    static TaskPriority CurrentPriority();
+    static void SetThreadPriority(TaskPriority prio);
+
+    // ===== 统计 =====
+    // 自上次 ResetStats 以来工作线程执行任务的时间占比（0..1）
+    double Utilization() const;
+    double WorkerUtilization(int index) const;
+    const MetricsRegistry& Metrics() const { return metrics.registry; }
+    void ResetStats();
+    void PrintStats() const;
+
+private:
+    TaskScheduler() = default;
+    ~TaskScheduler() { Shutdown(); }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskPriority prio = TaskPriority::Normal;
+        Clock::time_point queuedAt;
+    };
+
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Task> q[PRIORITIES];
+        std::thread thread;
+        std::atomic<uint64_t> busyNs{0};
+    };
+
+    void workerLoop(int index);
+    bool takeTask(int self, Task& task);
+    bool popOwn(int self, int prio, Task& task);
+    bool popInjected(int prio, Task& task);
+    bool steal(int self, int prio, Task& task);
+    void runTask(int self, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> workerCount{0};
+    std::mutex startMtx;
+
+    std::mutex injectMtx;
+    std::deque<Task> injected[PRIORITIES];
+
+    // 空闲的工作线程在这里睡眠；pending 为已提交未取走的任务数
+    std::mutex sleepMtx;
+    std::condition_variable sleepCv;
+    std::atomic<int>  pending{0};
+    std::atomic<int>  sleeping{0};
+    std::atomic<bool> stopping{false};
+
+    std::atomic<Clock::rep> statsSince{0};
+
+    struct SchedulerMetrics {
+        MetricsRegistry registry;
+
+        Counter& tasks        = registry.AddCounter("tasks_run");
+        Counter& steals       = registry.AddCounter("tasks_stolen");
+        Counter& parallelJobs = registry.AddCounter("parallel_jobs");     // ParallelFor 的作业数（含 FFmpeg execute）
+
+        // 提交到开始执行的等待（微秒），按优先级
+        LatencyHistogram& queueHigh   = registry.AddHistogram("task_queue_high");
+        LatencyHistogram& queueNormal = registry.AddHistogram("task_queue_normal");
+        LatencyHistogram& queueLow    = registry.AddHistogram("task_queue_low");
+        LatencyHistogram& run         = registry.AddHistogram("task_run");
+
+        LatencyHistogram& Queue(TaskPriority p)
+        {
+            return p == TaskPriority::High ? queueHigh : p == TaskPriority::Normal ? queueNormal : queueLow;
+        }
+    } metrics;
+};
+
+#endif
@@ -0,0 +1,345 @@
+#include "ThumbnailExtractor.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
+/* ========== 构析 ========== */
+ThumbnailExtractor::ThumbnailExtractor(const PlayerOptions& options) : opts(options) {}
+ThumbnailExtractor::~ThumbnailExtractor() { Close(); }
+
+/* -------- Open -------- */
+bool ThumbnailExtractor::Open(const std::string& path)
+{
+    Close();
+    file = path;
+
+    fmt = avformat_alloc_context();
+    if (!fmt) {
+        std::cerr << "Failed to allocate format context\n";
+        return false;
+    }
+    if (opts.fastStart) {
+        fmt->probesize = opts.probeSize;
+        fmt->max_analyze_duration = opts.analyzeDurationUs;
+        fmt->fps_probe_size = 0;
+    }
+    if (avformat_open_input(&fmt, path.c_str(), nullptr, nullptr) < 0) {
+        std::cerr << "Failed to open input file: " << path << "\n";
+        return false;
+    }
+    if (avformat_find_stream_info(fmt, nullptr) < 0) {
+        std::cerr << "Failed to find stream info\n";
+        return false;
+    }
+
+    vIdx = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (vIdx < 0) {
+        std::cerr << "No video stream found\n";
+        return false;
+    }
+    if (!avcodec_find_decoder(fmt->streams[vIdx]->codecpar->codec_id)) {
+        std::cerr << "Unsupported video codec\n";
+        return false;
+    }
+
+    keyIndex.Build(fmt->streams[vIdx]);
+    std::cout << "Keyframe index: " << keyIndex.Size() << " entries\n";
+    return true;
+}
+
+void ThumbnailExtractor::Close()
+{
+    for (SlotDecoder& slot : slots) closeSlot(slot);
+    slots.clear();
+    if (fmt) avformat_close_input(&fmt);
+    fmt = nullptr;
+    vIdx = -1;
+    keyIndex.Clear();
+}
+
+double ThumbnailExtractor::Duration() const
+{
+    if (!fmt) return 0.0;
+    if (fmt->duration != AV_NOPTS_VALUE) return fmt->duration / static_cast<double>(AV_TIME_BASE);
+    const AVStream* vs = fmt->streams[vIdx];
+    return vs->duration != AV_NOPTS_VALUE ? vs->duration * av_q2d(vs->time_base) : 0.0;
+}
+
+/* -------- Extract -------- */
+std::vector<Thumbnail> ThumbnailExtractor::Extract(int count, int width)
+{
+    std::vector<Thumbnail> result;
+    if (!fmt || count <= 0) return result;
+
+    const AVStream* vs = fmt->streams[vIdx];
+    int srcW = vs->codecpar->width, srcH = vs->codecpar->height;
+    if (srcW <= 0 || srcH <= 0) {
+        std::cerr << "Unknown video size\n";
+        return result;
+    }
+    thumbW = std::max(2, width) & ~1;
+    thumbH = std::max(2, static_cast<int>(std::lround(static_cast<double>(thumbW) * srcH / srcW)) & ~1);
+
+    // 均匀分布的目标位置映射到所在 GOP 的关键帧并去重；容器没有索引时按目标位置 seek
+    double start = fmt->start_time != AV_NOPTS_VALUE ? fmt->start_time / static_cast<double>(AV_TIME_BASE) : 0.0;
+    double duration = Duration();
+    std::vector<Job> jobs;
+    for (int i = 0; i < count; ++i) {
+        double t = start + duration * (i + 0.5) / count;
+        int64_t ts = static_cast<int64_t>(t / av_q2d(vs->time_base));
+        if (keyIndex.Size() > 0) {
+            int64_t key = keyIndex.FindAtOrBefore(ts);
+            jobs.push_back({key != AV_NOPTS_VALUE ? key : keyIndex.Stamps().front(), true});
+        } else {
+            jobs.push_back({ts, false});
+        }
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.ts < b.ts; });
+    jobs.erase(std::unique(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.ts == b.ts; }),
+               jobs.end());
+
+    // 每个参与者一套解复用器 + 解码器；作业按时间顺序分发，各参与者的 seek 基本向前
+    TaskScheduler& scheduler = TaskScheduler::Instance();
+    scheduler.Start();
+    int parallel = opts.decodeThreads > 0 ? opts.decodeThreads : scheduler.WorkerCount() + 1;
+    parallel = std::min(parallel, static_cast<int>(jobs.size()));
+    slots.resize(std::max(parallel, static_cast<int>(slots.size())));
+
+    std::vector<Thumbnail> thumbs(jobs.size());
+    auto t0 = std::chrono::steady_clock::now();
+    scheduler.ParallelFor(static_cast<int>(jobs.size()), parallel, opts.taskPriority, [&](int job, int slot) {
+        SlotDecoder& d = slots[slot];
+        if (!d.dec && !openSlot(d)) return;
+        if (!decodeJob(d, jobs[job], thumbs[job])) thumbs[job].rgba.clear();
+    });
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    // 失败的作业丢弃；没有索引时不同目标可能落在同一关键帧上，按 PTS 再去重一次
+    for (Thumbnail& t : thumbs) {
+        if (t.rgba.empty()) continue;
+        if (!result.empty() && result.back().pts == t.pts) continue;
+        result.push_back(std::move(t));
+    }
+
+    std::cout << "Thumbnails: " << result.size() << " of " << jobs.size() << " keyframes, " << thumbW << "x" << thumbH
+              << " in " << std::fixed << std::setprecision(1) << ms << " ms ("
+              << (ms > 0 ? result.size() * 1000.0 / ms : 0.0) << "/s, " << parallel << " decoders)\n";
+    return result;
+}
+
+/* ---- 参与者的解复用器与解码器 ---- */
+bool ThumbnailExtractor::openSlot(SlotDecoder& slot)
+{
+    // 沿用主上下文探测出的容器格式，流参数直接取自主上下文，不再探测
+    if (avformat_open_input(&slot.fmt, file.c_str(), fmt->iformat, nullptr) < 0 ||
+        static_cast<int>(slot.fmt->nb_streams) <= vIdx) {
+        std::cerr << "Failed to open input file: " << file << "\n";
+        closeSlot(slot);
+        return false;
+    }
+
+    const AVCodecParameters* par = fmt->streams[vIdx]->codecpar;
+    const AVCodec* decoder = avcodec_find_decoder(par->codec_id);
+    slot.dec = avcodec_alloc_context3(decoder);
+    if (!slot.dec || avcodec_parameters_to_context(slot.dec, par) < 0) {
+        std::cerr << "Failed to set up video codec context\n";
+        closeSlot(slot);
+        return false;
+    }
+
+    // 并行在作业之间，每个解码器单线程；只解码关键帧，缩小后看不出的环路滤波也跳过
+    slot.dec->thread_count = 1;
+    slot.dec->skip_frame = AVDISCARD_NONKEY;
+    slot.dec->skip_loop_filter = AVDISCARD_ALL;
+    if (avcodec_open2(slot.dec, decoder, nullptr) < 0) {
+        std::cerr << "Failed to open video codec\n";
+        closeSlot(slot);
+        return false;
+    }
+
+    slot.pkt = av_packet_alloc();
+    slot.frame = av_frame_alloc();
+    if (!slot.pkt || !slot.frame) {
+        closeSlot(slot);
+        return false;
+    }
+    return true;
+}
+
+void ThumbnailExtractor::closeSlot(SlotDecoder& slot)
+{
+    if (slot.pkt) av_packet_free(&slot.pkt);
+    if (slot.frame) av_frame_free(&slot.frame);
+    if (slot.dec) avcodec_free_context(&slot.dec);
+    if (slot.fmt) avformat_close_input(&slot.fmt);
+    if (slot.sws) sws_freeContext(slot.sws);
+    slot = SlotDecoder();
+}
+
+/* ---- 单个关键帧 ---- */
+bool ThumbnailExtractor::decodeJob(SlotDecoder& d, const Job& job, Thumbnail& out)
+{
+    int ret = job.keyframe ? av_seek_frame(d.fmt, vIdx, job.ts, AVSEEK_FLAG_BACKWARD)
+                           : avformat_seek_file(d.fmt, vIdx, INT64_MIN, job.ts, job.ts, 0);
+    if (ret < 0) return false;
+
+    // 读到第一个视频关键帧包
+    bool sent = false;
+    while (!sent && av_read_frame(d.fmt, d.pkt) >= 0) {
+        if (d.pkt->stream_index == vIdx && (d.pkt->flags & AV_PKT_FLAG_KEY)) {
+            sent = avcodec_send_packet(d.dec, d.pkt) >= 0;
+            if (!sent) {
+                av_packet_unref(d.pkt);
+                break;
+            }
+        }
+        av_packet_unref(d.pkt);
+    }
+    if (!sent) {
+        avcodec_flush_buffers(d.dec);
+        return false;
+    }
+
+    // 只送入这一个包就冲刷：有重排延迟（B 帧）的解码器也立即输出这一帧，不用再读后续的包
+    avcodec_send_packet(d.dec, nullptr);
+    bool ok = avcodec_receive_frame(d.dec, d.frame) >= 0;
+    if (ok) {
+        int64_t ts = d.frame->best_effort_timestamp;
+        out.pts = ts != AV_NOPTS_VALUE ? ts * av_q2d(d.fmt->streams[vIdx]->time_base) : -1.0;
+        ok = scaleFrame(d, d.frame, out);
+        av_frame_unref(d.frame);
+    }
+    // 冲刷之后必须重置才能接着送包
+    avcodec_flush_buffers(d.dec);
+    return ok;
+}
+
+bool ThumbnailExtractor::scaleFrame(SlotDecoder& d, const AVFrame* frame, Thumbnail& out)
+{
+    auto srcFmt = static_cast<AVPixelFormat>(frame->format);
+    d.sws = sws_getCachedContext(d.sws, frame->width, frame->height, srcFmt,
+                                 thumbW, thumbH, AV_PIX_FMT_RGBA,
+                                 SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!d.sws) return false;
+
+    // 按帧的色彩空间和范围转换，未标注时按高度猜测（与 GL 路径一致）
+    int cs = frame->colorspace != AVCOL_SPC_UNSPECIFIED ? frame->colorspace
+           : frame->height >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+    sws_setColorspaceDetails(d.sws, sws_getCoefficients(cs), frame->color_range == AVCOL_RANGE_JPEG,
+                             sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+
+    out.rgba.resize(static_cast<size_t>(thumbW) * thumbH * 4);
+    uint8_t* dst[4] = {out.rgba.data(), nullptr, nullptr, nullptr};
+    int dstStride[4] = {thumbW * 4, 0, 0, 0};
+    sws_scale(d.sws, frame->data, frame->linesize, 0, frame->height, dst, dstStride);
+    return true;
+}
+
+/* ========== 雪碧图 ========== */
+static bool writePng(const std::string& path, const std::vector<uint8_t>& rgba, int w, int h)
+{
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_PNG);
+    if (!codec) {
+        std::cerr << "PNG encoder not available, use a .ppm output instead\n";
+        return false;
+    }
+    AVCodecContext* enc = avcodec_alloc_context3(codec);
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* pkt = av_packet_alloc();
+    bool ok = false;
+    if (enc && frame && pkt) {
+        enc->width = w;
+        enc->height = h;
+        enc->pix_fmt = AV_PIX_FMT_RGBA;
+        enc->time_base = AVRational{1, 1};
+        if (avcodec_open2(enc, codec, nullptr) >= 0) {
+            frame->format = AV_PIX_FMT_RGBA;
+            frame->width = w;
+            frame->height = h;
+            frame->data[0] = const_cast<uint8_t*>(rgba.data());
+            frame->linesize[0] = w * 4;
+            if (avcodec_send_frame(enc, frame) >= 0 && avcodec_send_frame(enc, nullptr) >= 0 &&
+                avcodec_receive_packet(enc, pkt) >= 0) {
+                std::ofstream f(path, std::ios::binary);
+                f.write(reinterpret_cast<const char*>(pkt->data), pkt->size);
+                ok = static_cast<bool>(f);
+            }
+        }
+    }
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    return ok;
+}
+
+static bool writePpm(const std::string& path, const std::vector<uint8_t>& rgba, int w, int h)
+{
+    std::ofstream f(path, std::ios::binary);
+    f << "P6\n" << w << " " << h << "\n255\n";
+    std::vector<uint8_t> row(static_cast<size_t>(w) * 3);
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* src = rgba.data() + static_cast<size_t>(y) * w * 4;
+        for (int x = 0; x < w; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        f.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(f);
+}
+
+bool ThumbnailExtractor::WriteSpriteSheet(const std::string& path, const std::vector<Thumbnail>& thumbs,
+                                          int width, int height, int cols)
+{
+    if (thumbs.empty() || width <= 0 || height <= 0) return false;
+    cols = std::max(1, std::min(cols, static_cast<int>(thumbs.size())));
+    int rows = static_cast<int>((thumbs.size() + cols - 1) / cols);
+    int sheetW = cols * width, sheetH = rows * height;
+
+    std::vector<uint8_t> sheet(static_cast<size_t>(sheetW) * sheetH * 4, 0);
+    std::ofstream index(path + ".txt");
+    index << "# " << width << "x" << height << " cols=" << cols << "\n" << std::fixed << std::setprecision(6);
+    for (size_t i = 0; i < thumbs.size(); ++i) {
+        int x = static_cast<int>(i % cols) * width;
+        int y = static_cast<int>(i / cols) * height;
+        for (int row = 0; row < height; ++row) {
+            std::copy_n(thumbs[i].rgba.data() + static_cast<size_t>(row) * width * 4, width * 4,
+                        sheet.data() + (static_cast<size_t>(y + row) * sheetW + x) * 4);
+        }
+        index << i << " " << thumbs[i].pts << " " << x << " " << y << "\n";
+    }
+    if (!index) return false;
+
+    bool png = path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+    return png ? writePng(path, sheet, sheetW, sheetH) : writePpm(path, sheet, sheetW, sheetH);
+}
+
+/* ========== 命令行入口 ========== */
+int RunThumbnailExport(const std::string& file, const std::string& output, int count, int width, int cols,
+                       const PlayerOptions& options)
+{
+    ThumbnailExtractor extractor(options);
+    if (!extractor.Open(file)) return 1;
+
+    std::vector<Thumbnail> thumbs = extractor.Extract(count, width);
+    if (thumbs.empty()) {
+        std::cerr << "No thumbnails extracted\n";
+        return 1;
+    }
+    if (!ThumbnailExtractor::WriteSpriteSheet(output, thumbs, extractor.ThumbWidth(), extractor.ThumbHeight(), cols)) {
+        std::cerr << "Failed to write sprite sheet: " << output << "\n";
+        return 1;
+    }
+    std::cout << "Sprite sheet: " << output << " (" << thumbs.size() << " thumbnails, index " << output << ".txt)\n";
+    return 0;
+}
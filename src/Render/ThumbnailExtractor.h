@@ -0,0 +1,83 @@
+#ifndef THUMBNAILEXTRACTOR_H
+#define THUMBNAILEXTRACTOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "KeyframeIndex.h"
+#include "PlayerOptions.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+struct Thumbnail {
+    double pts = -1.0;              // 关键帧的显示时间（秒）
+    std::vector<uint8_t> rgba;      // ThumbWidth() * ThumbHeight() 个 RGBA 像素
+};
+
+// 预览用的缩略图提取：只解码关键帧（skip_frame = AVDISCARD_NONKEY），按关键帧索引 seek，
+// 缩小后输出带时间戳的 RGBA 数组或拼成一张雪碧图。
+// Open 与 MediaSession::LoadMedia 一样打开解复用器（有界探测）并从容器索引构建 KeyframeIndex；
+// 提取时每个关键帧是一个作业，由共享任务池的 ParallelFor 分给各核，每个参与者（slot）持有自己的
+// 解复用器与单线程解码器，作业之间只有 seek，没有帧间解码
+class ThumbnailExtractor {
+public:
+    explicit ThumbnailExtractor(const PlayerOptions& options = PlayerOptions());
+    ~ThumbnailExtractor();
+
+    ThumbnailExtractor(const ThumbnailExtractor&) = delete;
+    ThumbnailExtractor& operator=(const ThumbnailExtractor&) = delete;
+
+    bool Open(const std::string& file);
+    void Close();
+
+    // 在整个时长上均匀取 count 个位置，解码各自所在 GOP 的关键帧并缩小到 width 宽（高度按宽高比）。
+    // 多个位置落在同一关键帧上时只输出一次，结果可能少于 count；按时间升序返回
+    std::vector<Thumbnail> Extract(int count, int width);
+
+    int    ThumbWidth() const { return thumbW; }
+    int    ThumbHeight() const { return thumbH; }
+    double Duration() const;
+
+    // 按 cols 列拼接：.png 经 FFmpeg 的 PNG 编码器，其他扩展名写 PPM（P6）。
+    // 同时写 path + ".txt" 索引，每行 "<序号> <pts 秒> <x> <y>"
+    static bool WriteSpriteSheet(const std::string& path, const std::vector<Thumbnail>& thumbs,
+                                 int width, int height, int cols);
+
+private:
+    // 一个并行参与者的解复用器与解码器，第一次使用时打开
+    struct SlotDecoder {
+        AVFormatContext* fmt = nullptr;
+        AVCodecContext*  dec = nullptr;
+        AVPacket*        pkt = nullptr;
+        AVFrame*         frame = nullptr;
+        SwsContext*      sws = nullptr;
+    };
+
+    struct Job {
+        int64_t ts = 0;          // 流时间基
+        bool    keyframe = false; // true：索引中的关键帧时间戳；false：没有索引时的目标位置
+    };
+
+    bool openSlot(SlotDecoder& slot);
+    void closeSlot(SlotDecoder& slot);
+    bool decodeJob(SlotDecoder& slot, const Job& job, Thumbnail& out);
+    bool scaleFrame(SlotDecoder& slot, const AVFrame* frame, Thumbnail& out);
+
+    PlayerOptions opts;
+    std::string   file;
+    AVFormatContext* fmt = nullptr;
+    int vIdx = -1;
+    KeyframeIndex keyIndex;
+    std::vector<SlotDecoder> slots;
+    int thumbW = 0, thumbH = 0;
+};
+
+// 命令行入口：提取 count 张缩略图写成雪碧图 output，打印吞吐。返回 0 表示成功
+int RunThumbnailExport(const std::string& file, const std::string& output, int count, int width, int cols,
+                       const PlayerOptions& options = PlayerOptions());
+
+#endif
@@ -0,0 +1,146 @@
+#include "Trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/* ---- 线程缓冲 ---- */
+Tracer::ThreadLease& Tracer::lease()
+{
+    thread_local ThreadLease l;
+    return l;
+}
+
+// 线程局部对象先于静态对象析构，此时 Tracer 仍然有效
+Tracer::ThreadLease::~ThreadLease()
+{
+    if (buf) Tracer::Instance().releaseBuffer(buf);
+}
+
+Tracer::ThreadBuffer* Tracer::acquireBuffer(const char* name)
+{
+    std::lock_guard<std::mutex> lock(buffersMtx);
+    // 只复用事件已被 Clear 丢弃的空闲缓冲：已退出线程尚未导出的事件（如打开线程）保留到下一次 Clear
+    auto reusable = std::find_if(freeBuffers.begin(), freeBuffers.end(), [](const ThreadBuffer* b) {
+        return b->tail.load(std::memory_order_relaxed) == b->head.load(std::memory_order_relaxed);
+    });
+    ThreadBuffer* buf;
+    if (reusable != freeBuffers.end()) {
+        buf = *reusable;
+        freeBuffers.erase(reusable);
+        buf->tid = nextTid++;
+    } else {
+        buffers.push_back(std::make_unique<ThreadBuffer>(nextTid++));
+        buf = buffers.back().get();
+    }
+    buf->threadName.store(name, std::memory_order_release);
+    return buf;
+}
+
+void Tracer::releaseBuffer(ThreadBuffer* buf)
+{
+    std::lock_guard<std::mutex> lock(buffersMtx);
+    freeBuffers.push_back(buf);
+}
+
+void Tracer::SetThreadName(const char* name)
+{
+    ThreadLease& l = lease();
+    l.name = name;
+    if (l.buf) l.buf->threadName.store(name, std::memory_order_release);
+}
+
+void Tracer::Record(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    // 只在开启追踪时调用：第一次记录才取得缓冲
+    ThreadLease& l = lease();
+    if (!l.buf) l.buf = acquireBuffer(l.name);
+    ThreadBuffer* buf = l.buf;
+    uint64_t idx = buf->head.load(std::memory_order_relaxed);
+    // 先声明要覆盖的槽位，导出线程据此判断拷贝到的事件是否可能被改写
+    buf->claimed.store(idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Event& e = buf->events[idx % EVENTS_PER_THREAD];
+    e.name.store(name, std::memory_order_relaxed);
+    e.startNs.store(startNs, std::memory_order_relaxed);
+    e.durNs.store(endNs - startNs, std::memory_order_relaxed);
+    // 发布：读取方先读 head 再读事件
+    buf->head.store(idx + 1, std::memory_order_release);
+}
+
+void Tracer::Clear()
+{
+    std::lock_guard<std::mutex> lock(buffersMtx);
+    for (auto& buf : buffers) {
+        buf->tail.store(buf->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+static void writeJsonString(std::ostream& os, const char* s)
+{
+    os << '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') os << '\\';
+        os << *s;
+    }
+    os << '"';
+}
+
+bool Tracer::WriteChromeJson(const std::string& path) const
+{
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    size_t written = 0;
+
+    std::lock_guard<std::mutex> lock(buffersMtx);
+    for (const auto& buf : buffers) {
+        if (const char* threadName = buf->threadName.load(std::memory_order_acquire)) {
+            json << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buf->tid
+                 << ",\"args\":{\"name\":";
+            writeJsonString(json, threadName);
+            json << "}}";
+            first = false;
+        }
+
+        // 拷贝期间写入线程可能继续覆盖最旧的事件：拷贝后检查写入进度，丢弃可能被覆盖的部分
+        uint64_t head = buf->head.load(std::memory_order_acquire);
+        uint64_t from = std::max(buf->tail.load(std::memory_order_relaxed),
+                                 head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0);
+        struct Copy { const char* name; uint64_t startNs, durNs; };
+        std::vector<Copy> copies;
+        copies.reserve(static_cast<size_t>(head - from));
+        for (uint64_t i = from; i < head; ++i) {
+            const Event& e = buf->events[i % EVENTS_PER_THREAD];
+            copies.push_back({e.name.load(std::memory_order_relaxed),
+                              e.startNs.load(std::memory_order_relaxed),
+                              e.durNs.load(std::memory_order_relaxed)});
+        }
+        // 拷贝期间开始写入的事件覆盖的是 claimed - EVENTS_PER_THREAD 之前的槽位，这些拷贝不可信
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t claimed = buf->claimed.load(std::memory_order_relaxed);
+        uint64_t safeFrom = claimed > EVENTS_PER_THREAD ? claimed - EVENTS_PER_THREAD : 0;
+
+        for (uint64_t i = std::max(from, safeFrom); i < head; ++i) {
+            const Copy& c = copies[static_cast<size_t>(i - from)];
+            if (!c.name) continue;
+            json << (first ? "" : ",") << "\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid << ",\"name\":";
+            writeJsonString(json, c.name);
+            json << ",\"ts\":" << c.startNs / 1000.0 << ",\"dur\":" << c.durNs / 1000.0 << "}";
+            first = false;
+            written++;
+        }
+    }
+    json << "\n]}\n";
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open trace file: " << path << "\n";
+        return false;
+    }
+    out << json.str();
+    std::cout << "[Trace] " << written << " events written to " << path << "\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,126 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 热路径的作用域追踪，导出为 Chrome trace-event JSON（chrome://tracing、ui.perfetto.dev 可直接打开）。
+//
+// - 编译期：未定义 ENABLE_TRACE 时 TRACE_SCOPE / TRACE_THREAD_NAME 展开为空，没有任何开销；
+// - 运行期：Tracer::SetEnabled 切换，关闭时每个作用域只多一次 relaxed 原子读；
+// - 每个线程在开启追踪后第一次记录时才取得自己的环形事件缓冲，写入只由该线程进行，不加锁；
+//   缓冲写满后覆盖最旧的事件，导出时保留每个线程最近 EVENTS_PER_THREAD 个事件；
+//   线程退出时缓冲归还空闲列表，事件被 Clear 之后由新线程复用；从不记录的线程没有任何分配。
+// 事件名必须是字符串字面量（只保存指针）。
+
+class Tracer {
+public:
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+    static Tracer& Instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void SetEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // 当前线程在追踪视图中显示的名字（字符串字面量）；只保存在线程局部变量中，不分配缓冲
+    void SetThreadName(const char* name);
+
+    // 记录一个已完成的作用域（当前线程）
+    void Record(const char* name, uint64_t startNs, uint64_t endNs);
+    uint64_t NowNs() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    // 把所有线程缓冲中的事件写成 Chrome trace JSON；可以在记录过程中调用
+    bool WriteChromeJson(const std::string& path) const;
+    // 丢弃已记录的事件
+    void Clear();
+
+private:
+    struct Event {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> startNs{0};
+        std::atomic<uint64_t> durNs{0};
+    };
+
+    // 单线程写入的环形缓冲：claimed 为已开始写入的事件数，head 为已写完的事件数
+    struct ThreadBuffer {
+        explicit ThreadBuffer(int tid) : tid(tid), events(new Event[EVENTS_PER_THREAD]) {}
+        int tid;                         // 复用时换成新线程的序号（buffersMtx 保护）
+        std::atomic<const char*> threadName{nullptr};
+        std::atomic<uint64_t> claimed{0};
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};   // Clear 时把 head 记为新的起点
+        std::unique_ptr<Event[]> events;
+    };
+
+    // 线程局部的名字与缓冲租约：线程退出时析构，把缓冲归还空闲列表
+    struct ThreadLease {
+        const char*   name = nullptr;
+        ThreadBuffer* buf = nullptr;
+        ~ThreadLease();
+    };
+    static ThreadLease& lease();
+
+    Tracer() : epoch(std::chrono::steady_clock::now()) {}
+    ThreadBuffer* acquireBuffer(const char* name);
+    void releaseBuffer(ThreadBuffer* buf);
+
+    std::atomic<bool> enabled{false};
+    const std::chrono::steady_clock::time_point epoch;
+
+    // 线程退出后缓冲留在 buffers 中，其事件仍可导出；Clear 之后才由新线程复用。
+    // 反复 Play / Stop（每次开始记录时 Clear）时缓冲数量不超过一次播放中记录过事件的线程数
+    mutable std::mutex buffersMtx;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> freeBuffers;
+    int nextTid = 1;
+};
+
+// RAII 作用域：构造时读开关并取时间，析构时记录
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(name), active(Tracer::Instance().Enabled())
+    {
+        if (active) startNs = Tracer::Instance().NowNs();
+    }
+    ~TraceScope()
+    {
+        if (active) {
+            Tracer& t = Tracer::Instance();
+            t.Record(name, startNs, t.NowNs());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    bool active;
+    uint64_t startNs = 0;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_TRACE
+    #define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+    #define TRACE_THREAD_NAME(name) Tracer::Instance().SetThreadName(name)
+#else
+    #define TRACE_SCOPE(name) ((void)0)
+    #define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef VIDEOFRAME_H
+#define VIDEOFRAME_H
+
+#include <chrono>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+// 帧像素布局，与 FrameRenderer 着色器中的 uFormat 取值一致
+enum class FrameFormat : int {
+    RGB24 = 0,     // sws_scale 回退路径输出的紧凑 RGB24
+    YUVPlanar = 1, // Y/U/V 三个独立平面（420/422/444）
+    NV12 = 2       // Y 平面 + 交错 UV 平面
+};
+
+// 解码线程产出、渲染线程上传的一帧
+struct FrameData {
+    int width = 0;
+    int height = 0;
+    FrameFormat format = FrameFormat::RGB24;
+    AVFrame* frame = nullptr; // YUV 路径：解码器输出帧的引用，planes 直接指向其数据
+    uint8_t* data = nullptr;  // RGB24 / 缩小路径：帧缓冲池中的像素数据
+    uint8_t* planes[3] = {nullptr, nullptr, nullptr};
+    int linesize[3] = {0, 0, 0};
+    int chromaW = 0, chromaH = 0;                    // 色度平面尺寸
+    AVColorSpace colorspace = AVCOL_SPC_UNSPECIFIED;
+    AVColorRange colorRange = AVCOL_RANGE_UNSPECIFIED;
+    AVChromaLocation chromaLoc = AVCHROMA_LOC_UNSPECIFIED;
+    double pts = -1.0;        // 时间戳
+    int serial = 0;           // 播放序号，seek 之后旧序号的帧被丢弃
+    std::chrono::steady_clock::time_point queuedAt; // 入队时间，用于统计队列等待
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "VideoTexture.h"
+#include "Trace.h"
+#include <cstring>
+#include <iostream>
+
+bool VideoTexture::Init()
+{
+    Destroy();
+
+    // tex 用于 RGB 或 Y 平面，texU/texV 用于色度平面
+    GLuint* textures[] = {&tex, &texU, &texV};
+    for (GLuint* t : textures) {
+        glGenTextures(1, t);
+        glBindTexture(GL_TEXTURE_2D, *t);
+
+        // 设置纹理参数（GL_LINEAR 同时完成色度上采样）
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex != 0 && texU != 0 && texV != 0;
+}
+
+void VideoTexture::Destroy()
+{
+    pbo.Destroy();
+    if (tex) glDeleteTextures(1, &tex);
+    if (texU) glDeleteTextures(1, &texU);
+    if (texV) glDeleteTextures(1, &texV);
+    tex = texU = texV = 0;
+    texW = texH = 0;
+    texChromaW = texChromaH = 0;
+    uploaded = false;
+}
+
+void VideoTexture::Bind() const
+{
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, texU);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, texV);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+/* ---- 纹理分配 ---- */
+void VideoTexture::allocTextures(const FrameData& fd)
+{
+    if (fd.format == texFormat && fd.width == texW && fd.height == texH &&
+        fd.chromaW == texChromaW && fd.chromaH == texChromaH) {
+        return;
+    }
+
+    if (fd.format == FrameFormat::RGB24) {
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, fd.width, fd.height, 0,
+                     GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, fd.width, fd.height, 0,
+                     GL_RED, GL_UNSIGNED_BYTE, nullptr);
+
+        bool nv12 = fd.format == FrameFormat::NV12;
+        glBindTexture(GL_TEXTURE_2D, texU);
+        glTexImage2D(GL_TEXTURE_2D, 0, nv12 ? GL_RG8 : GL_R8, fd.chromaW, fd.chromaH, 0,
+                     nv12 ? GL_RG : GL_RED, GL_UNSIGNED_BYTE, nullptr);
+
+        if (!nv12) {
+            glBindTexture(GL_TEXTURE_2D, texV);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, fd.chromaW, fd.chromaH, 0,
+                         GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    texFormat = fd.format;
+    texW = fd.width;
+    texH = fd.height;
+    texChromaW = fd.chromaW;
+    texChromaH = fd.chromaH;
+}
+
+/* ---- 纹理上传 ---- */
+bool VideoTexture::Upload(const FrameData& fd, bool usePbo)
+{
+    TRACE_SCOPE("uploadFrame");
+    allocTextures(fd);
+
+    // 各平面的行数：RGB / Y 为整帧高度，色度平面为 chromaH
+    int planeCount = fd.format == FrameFormat::RGB24 ? 1 : (fd.format == FrameFormat::NV12 ? 2 : 3);
+    size_t planeBytes[3] = {0, 0, 0};
+    size_t total = 0;
+    for (int i = 0; i < planeCount; ++i) {
+        planeBytes[i] = static_cast<size_t>(fd.linesize[i]) * (i == 0 ? fd.height : fd.chromaH);
+        total += planeBytes[i];
+    }
+
+    // PBO 路径：拷贝到映射的缓冲后从缓冲偏移上传，驱动异步完成到纹理的拷贝；
+    // 缓冲仍在使用时退回直接上传，不等待 GPU
+    const void* src[3] = {fd.planes[0], fd.planes[1], fd.planes[2]};
+    uint8_t* mapped = nullptr;
+    if (usePbo) {
+        if (!pbo.Valid() || total > pbo.BufferSize()) {
+            if (pbo.Init(total, PBO_COUNT)) {
+                std::cout << "PBO upload: " << pbo.BufferCount() << " x " << total << " bytes"
+                          << (pbo.Persistent() ? " (persistent mapping)" : " (per-frame mapping)") << "\n";
+            }
+        }
+        mapped = pbo.Begin(total);
+    }
+    if (mapped) {
+        size_t offset = 0;
+        for (int i = 0; i < planeCount; ++i) {
+            memcpy(mapped + offset, fd.planes[i], planeBytes[i]);
+            src[i] = reinterpret_cast<const void*>(offset);
+            offset += planeBytes[i];
+        }
+        pbo.Commit();
+    }
+
+    // 平面行宽可能不是 4 字节对齐
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    {
+        TRACE_SCOPE("glTexSubImage2D");
+        if (fd.format == FrameFormat::RGB24) {
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, fd.linesize[0] / 3);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fd.width, fd.height,
+                            GL_RGB, GL_UNSIGNED_BYTE, src[0]);
+        } else {
+            bool nv12 = fd.format == FrameFormat::NV12;
+
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, fd.linesize[0]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fd.width, fd.height,
+                            GL_RED, GL_UNSIGNED_BYTE, src[0]);
+
+            glBindTexture(GL_TEXTURE_2D, texU);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, nv12 ? fd.linesize[1] / 2 : fd.linesize[1]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fd.chromaW, fd.chromaH,
+                            nv12 ? GL_RG : GL_RED, GL_UNSIGNED_BYTE, src[1]);
+
+            if (!nv12) {
+                glBindTexture(GL_TEXTURE_2D, texV);
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, fd.linesize[2]);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fd.chromaW, fd.chromaH,
+                                GL_RED, GL_UNSIGNED_BYTE, src[2]);
+            }
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (mapped) pbo.End();
+
+    colorspace = fd.colorspace;
+    colorRange = fd.colorRange;
+    chromaLoc  = fd.chromaLoc;
+    uploaded = true;
+    return mapped != nullptr;
+}
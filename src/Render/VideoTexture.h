@@ -0,0 +1,61 @@
+#ifndef VIDEOTEXTURE_H
+#define VIDEOTEXTURE_H
+
+#include <glad/glad.h>
+#include "PboRing.h"
+#include "VideoFrame.h"
+
+// 一路视频的纹理：RGB24 使用 tex，YUV 使用 tex（Y）+ texU/texV（色度，NV12 只用 texU）。
+// 帧的格式或尺寸变化时重新分配纹理存储；上传可经 PBO 环异步完成。
+// 记录最近一帧的颜色参数，由 FrameRenderer 绘制时设置着色器 uniform。
+// 所有方法只能在持有 GL 上下文的线程调用
+class VideoTexture {
+public:
+    static constexpr int PBO_COUNT = 3;
+
+    VideoTexture() = default;
+    ~VideoTexture() = default; // GL 对象由 Destroy 在上下文销毁前释放
+
+    VideoTexture(const VideoTexture&) = delete;
+    VideoTexture& operator=(const VideoTexture&) = delete;
+
+    bool Init();
+    void Destroy();
+
+    // 上传一帧；返回是否经由 PBO 完成（PBO 关闭或缓冲忙时为直接上传）
+    bool Upload(const FrameData& fd, bool usePbo);
+    bool HasFrame() const { return uploaded; }
+
+    // 绑定到纹理单元 0/1/2
+    void Bind() const;
+
+    FrameFormat      Format()    const { return texFormat; }
+    int              Width()     const { return texW; }
+    int              Height()    const { return texH; }
+    int              ChromaW()   const { return texChromaW; }
+    int              ChromaH()   const { return texChromaH; }
+    AVColorSpace     Colorspace() const { return colorspace; }
+    bool             FullRange() const { return colorRange == AVCOL_RANGE_JPEG; }
+    AVChromaLocation ChromaLoc() const { return chromaLoc; }
+    const PboRing&   Pbo()       const { return pbo; }
+
+private:
+    void allocTextures(const FrameData& fd);
+
+    GLuint tex = 0, texU = 0, texV = 0;
+
+    // 当前纹理的几何与格式
+    FrameFormat texFormat = FrameFormat::RGB24;
+    int texW = 0, texH = 0;
+    int texChromaW = 0, texChromaH = 0;
+    bool uploaded = false;
+
+    // 最近一帧的颜色参数
+    AVColorSpace colorspace = AVCOL_SPC_UNSPECIFIED;
+    AVColorRange colorRange = AVCOL_RANGE_UNSPECIFIED;
+    AVChromaLocation chromaLoc = AVCHROMA_LOC_UNSPECIFIED;
+
+    PboRing pbo;
+};
+
+#endif
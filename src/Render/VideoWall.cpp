@@ -0,0 +1,286 @@
+#include "VideoWall.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+/* ========== 构析 ========== */
+VideoWall::VideoWall(const PlayerOptions& options) : opts(options) {}
+VideoWall::~VideoWall() { CleanUp(); }
+
+// 每一路的参数：只有第一路出声，它的视频任务也按高优先级调度（音画同步只在这一路上听得出来）；
+// 不用共享任务池时解码线程数按核数平分，避免 N 路各自按全部核数开线程；帧缓存预算按路数平分；指标文件按序号区分
+PlayerOptions VideoWall::tileOptions(size_t index, size_t count) const
+{
+    PlayerOptions o = opts;
+    o.headless = false;
+    o.disableAudio = opts.disableAudio || index > 0;
+    if (o.sharedPool && !o.disableAudio) o.taskPriority = TaskPriority::High;
+    if (!o.sharedPool && o.decodeThreads == 0) {
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        o.decodeThreads = std::max(1, static_cast<int>(hw / count));
+    }
+    o.frameCacheMB = opts.frameCacheMB / count;
+    if (!o.metricsFile.empty()) {
+        o.metricsFile += "." + std::to_string(index);
+    }
+    return o;
+}
+
+/* -------- Initialize -------- */
+bool VideoWall::Initialize(const std::vector<std::string>& files)
+{
+    if (files.empty()) {
+        std::cerr << "Video wall needs at least one file\n";
+        return false;
+    }
+    size_t count = std::min(files.size(), static_cast<size_t>(MAX_TILES));
+    if (files.size() > count) {
+        std::cerr << "Video wall supports up to " << MAX_TILES << " streams, ignoring the rest\n";
+    }
+
+    cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    rows = static_cast<int>((count + cols - 1) / cols);
+
+    // 各路解复用器在后台并行打开，与窗口/GL 初始化同时进行
+    for (size_t i = 0; i < count; ++i) {
+        auto tile = std::make_unique<Tile>();
+        tile->file = files[i];
+        tile->session = std::make_unique<MediaSession>(tileOptions(i, count));
+        tile->session->OpenMediaAsync(files[i]);
+        tiles.push_back(std::move(tile));
+    }
+
+    if (!window.Create("Video Wall", WIN_W, WIN_H)) return false;
+    if (!renderer.Init()) return false;
+
+    // 每路在显示器上最大只占一个网格单元：按单元尺寸选择 lowres 级别和缩放缓冲池大小
+    int dw = 0, dh = 0;
+    bool haveDisplay = window.DisplaySize(dw, dh);
+    for (auto& tile : tiles) {
+        MediaSession& s = *tile->session;
+        s.MarkGlReady();
+        if (haveDisplay) s.SetDisplayLimit(dw / cols, dh / rows);
+        if (!s.LoadMedia(tile->file)) {
+            std::cerr << "Failed to load " << tile->file << "\n";
+            return false;
+        }
+        if (!tile->texture.Init()) {
+            std::cerr << "Failed to create video textures\n";
+            return false;
+        }
+        s.ResetStats();
+    }
+
+    std::cout << "Video wall: " << tiles.size() << " streams in " << cols << "x" << rows << " grid\n";
+    updateLayout();
+    return true;
+}
+
+/* -------- Play / Stop -------- */
+void VideoWall::Play()
+{
+    if (opts.sharedPool) TaskScheduler::Instance().ResetStats();
+    if (!opts.traceFile.empty()) {
+        Tracer::Instance().Clear();
+        Tracer::Instance().SetEnabled(true);
+    }
+    for (auto& tile : tiles) tile->session->Play();
+}
+
+void VideoWall::Stop()
+{
+    bool wasPlaying = false;
+    for (auto& tile : tiles) {
+        wasPlaying |= tile->session->Playing();
+        tile->session->Stop();
+    }
+    if (!wasPlaying) return;
+
+    if (!opts.traceFile.empty() && Tracer::Instance().Enabled()) {
+        Tracer::Instance().SetEnabled(false);
+        Tracer::Instance().WriteChromeJson(opts.traceFile);
+    }
+    printStats();
+}
+
+/* -------- Run (主循环) -------- */
+void VideoWall::Run()
+{
+    if (!window.Valid()) {
+        std::cerr << "Window not initialized\n";
+        return;
+    }
+
+    TRACE_THREAD_NAME("render");
+    bool running = true;
+    window.ResetSwapClock();
+
+    int framesRendered = 0;
+    auto startTime = std::chrono::steady_clock::now();
+
+    while (running) {
+        TRACE_SCOPE("frame");
+        {
+            TRACE_SCOPE("handleEvents");
+            handleEvents(running);
+        }
+
+        // 各路按同一个 vsync 时刻独立选帧
+        auto now = std::chrono::steady_clock::now();
+        for (auto& tile : tiles) {
+            if (tile->session->WantsFrame() && renderTile(*tile, now)) {
+                framesRendered++;
+            }
+        }
+
+        {
+            TRACE_SCOPE("draw");
+            int dw = 0, dh = 0;
+            window.DrawableSize(dw, dh);
+            renderer.Clear(dw, dh);
+            for (auto& tile : tiles) {
+                renderer.Draw(tile->texture, tile->rect);
+            }
+        }
+
+        double swapUs = window.Swap();
+        auto presentedAt = std::chrono::steady_clock::now();
+        for (auto& tile : tiles) {
+            tile->session->Stats().present.RecordMicros(swapUs);
+            tile->session->Presented(presentedAt);
+        }
+
+        // 合计帧率（所有路之和）
+        auto currentTime = std::chrono::steady_clock::now();
+        auto elapsedSec = std::chrono::duration_cast<std::chrono::seconds>(currentTime - startTime).count();
+        if (elapsedSec >= 2) {
+            double fps = framesRendered / static_cast<double>(elapsedSec);
+            window.SetTitle("Video Wall | " + std::to_string(tiles.size()) + " streams | FPS: " +
+                            std::to_string(static_cast<int>(fps)));
+            startTime = currentTime;
+            framesRendered = 0;
+        }
+
+        window.WaitNextPeriod();
+    }
+
+    Stop();
+}
+
+/* ---- 选帧并上传 ---- */
+bool VideoWall::renderTile(Tile& tile, MediaSession::Clock::time_point now)
+{
+    MediaSession& s = *tile.session;
+    FrameData fd;
+    if (!s.PickFrame(now, window.NextVsync(now), window.VsyncPeriod(), fd)) {
+        return false;
+    }
+
+    MediaSession::SessionMetrics& m = s.Stats();
+    StageTimer uploadTimer;
+    bool viaPbo = tile.texture.Upload(fd, opts.usePbo);
+    (viaPbo ? m.uploadPbo : m.uploadDirect).RecordMicros(uploadTimer.ElapsedMicros());
+    if (opts.usePbo && !viaPbo) m.pboBusySkips.Add();
+
+    s.FrameShown(fd, now);
+    return true;
+}
+
+/* ---- 事件处理 ---- */
+// 所有路同时暂停 / seek；seek 以第一路的位置为基准
+void VideoWall::handleEvents(bool& running)
+{
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (!window.Owns(event)) continue;
+
+        switch (event.type) {
+            case SDL_QUIT:
+                running = false;
+                break;
+
+            case SDL_KEYDOWN: {
+                MediaSession& lead = *tiles.front()->session;
+                if (event.key.keysym.sym == SDLK_ESCAPE) {
+                    running = false;
+                } else if (event.key.keysym.sym == SDLK_SPACE) {
+                    bool resume = lead.Paused();
+                    for (auto& tile : tiles) {
+                        resume ? tile->session->Play() : tile->session->Pause();
+                    }
+                } else if (event.key.keysym.sym == SDLK_LEFT || event.key.keysym.sym == SDLK_RIGHT) {
+                    double step = event.key.keysym.sym == SDLK_LEFT ? -SEEK_STEP : SEEK_STEP;
+                    double target = lead.Position() + step;
+                    for (auto& tile : tiles) tile->session->Seek(target);
+                } else if (event.key.keysym.sym == SDLK_COMMA || event.key.keysym.sym == SDLK_PERIOD) {
+                    int dir = event.key.keysym.sym == SDLK_COMMA ? -1 : 1;
+                    for (auto& tile : tiles) tile->session->StepFrame(dir);
+                } else if (event.key.keysym.sym == SDLK_s) {
+                    printStats();
+                } else if (event.key.keysym.sym == SDLK_r) {
+                    for (auto& tile : tiles) tile->session->ResetStats();
+                    if (opts.sharedPool) TaskScheduler::Instance().ResetStats();
+                    std::cout << "Sync statistics reset\n";
+                }
+                break;
+            }
+
+            case SDL_WINDOWEVENT:
+                if (event.window.event == SDL_WINDOWEVENT_RESIZED ||
+                    event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    updateLayout();
+                }
+                break;
+        }
+    }
+}
+
+/* ---- 网格布局 ---- */
+void VideoWall::updateLayout()
+{
+    int dw = 0, dh = 0;
+    window.DrawableSize(dw, dh);
+    if (dw <= 0 || dh <= 0) return;
+
+    int cellW = dw / cols;
+    int cellH = dh / rows;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        Tile& tile = *tiles[i];
+        int col = static_cast<int>(i) % cols;
+        int row = static_cast<int>(i) / cols;
+        // GL 坐标原点在左下角，第一行画在最上面
+        ViewRect cell{col * cellW, dh - (row + 1) * cellH, cellW, cellH};
+        tile.rect = FrameRenderer::Letterbox(cell, tile.session->AspectRatio());
+
+        // 解码线程下一帧起按单元尺寸缩放
+        tile.session->SetOutputLimit(tile.rect.w, tile.rect.h);
+    }
+}
+
+/* ---- 统计 ---- */
+void VideoWall::printStats() const
+{
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        std::cout << "\n[" << i << "] " << tiles[i]->file;
+        tiles[i]->session->PrintStats();
+    }
+    if (opts.sharedPool) TaskScheduler::Instance().PrintStats();
+}
+
+/* ---- 资源释放 ---- */
+void VideoWall::CleanUp()
+{
+    Stop();
+    for (auto& tile : tiles) tile->session->CleanUp();
+
+    // GL 对象在上下文销毁前释放
+    if (window.Valid()) {
+        window.MakeCurrent();
+        for (auto& tile : tiles) tile->texture.Destroy();
+        renderer.Destroy();
+    }
+    tiles.clear();
+    window.Destroy();
+}
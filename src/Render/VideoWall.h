@@ -0,0 +1,60 @@
+#ifndef VIDEOWALL_H
+#define VIDEOWALL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "MediaSession.h"
+#include "RenderWindow.h"
+#include "FrameRenderer.h"
+#include "VideoTexture.h"
+
+// 多路画面：N 个 MediaSession 按网格合成到同一个窗口 / GL 上下文。
+// 每路一个纹理，共用一个 FrameRenderer 和 vsync 节拍；只有第一路打开音频设备，其余按 External 时钟播放。
+// 各路的解码输出按网格单元尺寸缩小（lowres / 转换阶段缩放），多路 720p 时上传量与单路全屏相当。
+// opts.sharedPool 时各路的解复用 / 解码任务共用一个按核数创建的工作线程池
+class VideoWall {
+public:
+    static constexpr int MAX_TILES = 16;
+
+    explicit VideoWall(const PlayerOptions& options = PlayerOptions());
+    ~VideoWall();
+
+    VideoWall(const VideoWall&) = delete;
+    VideoWall& operator=(const VideoWall&) = delete;
+
+    // 创建窗口并加载全部文件（各路解复用器并行打开）；任意一路失败时返回 false
+    bool Initialize(const std::vector<std::string>& files);
+    void Play();
+    void Stop();
+    void Run();
+    void CleanUp();
+
+    size_t TileCount() const { return tiles.size(); }
+
+private:
+    static constexpr int WIN_W = 1280;
+    static constexpr int WIN_H = 720;
+    static constexpr double SEEK_STEP = 10.0;      // 左右方向键 seek 步长（秒）
+
+    struct Tile {
+        std::string file;
+        std::unique_ptr<MediaSession> session;
+        VideoTexture texture;
+        ViewRect rect;                    // 网格单元内按宽高比居中的视频区域
+    };
+
+    PlayerOptions opts;
+    RenderWindow  window;
+    FrameRenderer renderer;
+    std::vector<std::unique_ptr<Tile>> tiles;
+    int cols = 1, rows = 1;
+
+    PlayerOptions tileOptions(size_t index, size_t count) const;
+    bool   renderTile(Tile& tile, MediaSession::Clock::time_point now);
+    void   handleEvents(bool& running);
+    void   updateLayout();
+    void   printStats() const;
+};
+
+#endif
@@ -1,16 +1,190 @@
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
 #include "Render/PlayerRender.h"
+#include "Render/VideoWall.h"
+#include "Render/DecodeThreadBench.h"
+#include "Render/RawExport.h"
+#include "Render/ThumbnailExtractor.h"
 // // ffmpeg
 // extern "C" {
 // #include <libavcodec/avcodec.h>
 // #include <libavformat/avformat.h>
 // }
 
+static void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options] [video file...]\n"
+              << "  --threads N              video decoder threads (0 = auto); upper bound for the benchmark\n"
+              << "  --thread-type TYPE       auto | frame | slice\n"
+              << "  --bench-decode-threads   measure decode fps against thread count and exit\n"
+              << "  --no-pbo                 upload textures directly instead of through pixel buffer objects\n"
+              << "  --no-adaptive-size       always convert and upload frames at the native video size\n"
+              << "  --no-fast-start          full stream probing and wait for audio buffering before the first frame\n"
+              << "  --sync MODE              master clock: audio | video | external (default audio)\n"
+              << "  --input MODE             default | mmap | readahead (default readahead)\n"
+              << "  --read-ahead MB          read-ahead window size in MB (default 32)\n"
+              << "  --frame-cache MB         decoded-frame cache for instant back-stepping and nearby seeks (default 0 = off);\n"
+              << "                           costs one allocation and a full-frame copy per decoded frame on the decode stage\n"
+              << "  --frame-cache-scale N    store cached frames downscaled by N (default 1)\n"
+              << "  --frame-cache-420        store cached frames as 4:2:0\n"
+              << "  --metrics PATH           append metrics snapshots (JSON lines) to PATH\n"
+              << "  --metrics-interval MS    metrics snapshot interval (default 1000)\n"
+              << "  --trace PATH             record hot-path trace from start, write Chrome trace JSON to PATH on exit\n"
+              << "  --wall                   play all given files at once in a grid (up to 16, audio from the first)\n"
+              << "  --shared-pool            run demux/decode stages as tasks on one shared worker pool (default with --wall)\n"
+              << "  --no-shared-pool         one dedicated thread per pipeline stage (default for a single file)\n"
+              << "  --task-priority P        high | normal | low: priority of this session's video tasks in the shared pool\n"
+              << "  --export PATH            decode as fast as possible into a raw frame file at PATH (+ PATH.pts index) and exit\n"
+              << "  --export-format FMT      rgb24 | rgba | yuv420p (default rgb24)\n"
+              << "  --export-size WxH        resize exported frames; W or H may be 0 to keep the aspect ratio\n"
+              << "  --export-stride N        export every Nth decoded frame (default 1)\n"
+              << "  --thumbnails PATH        decode keyframes only into a sprite sheet at PATH (.png or .ppm, + PATH.txt) and exit\n"
+              << "  --thumb-count N          number of evenly spaced thumbnails (default 100)\n"
+              << "  --thumb-width W          thumbnail width in pixels, height keeps the aspect ratio (default 160)\n"
+              << "  --thumb-cols N           thumbnails per sprite sheet row (default 10)\n";
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "AmazingPlayer - Starting up..." << std::endl;
-    
+
+    // 解析命令行参数
+    PlayerOptions options;
+    std::string videoFile = "../src/wwdc-243.mp4";
+    std::vector<std::string> files;
+    bool benchThreads = false;
+    RawExportOptions exportOptions;
+    std::string thumbOutput;
+    int thumbCount = 100, thumbWidth = 160, thumbCols = 10;
+    bool wall = false;
+    int sharedPool = -1;   // -1: 按模式决定（多路画面默认开启）
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.decodeThreads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--thread-type") == 0 && i + 1 < argc) {
+            if (!ParseDecodeThreadType(argv[++i], options.decodeThreadType)) {
+                std::cerr << "Unknown thread type: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--bench-decode-threads") == 0) {
+            benchThreads = true;
+        } else if (std::strcmp(argv[i], "--no-pbo") == 0) {
+            options.usePbo = false;
+        } else if (std::strcmp(argv[i], "--no-adaptive-size") == 0) {
+            options.adaptiveSize = false;
+        } else if (std::strcmp(argv[i], "--no-fast-start") == 0) {
+            options.fastStart = false;
+        } else if (std::strcmp(argv[i], "--sync") == 0 && i + 1 < argc) {
+            if (!ParseSyncMode(argv[++i], options.syncMode)) {
+                std::cerr << "Unknown sync mode: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            if (!ParseInputMode(argv[++i], options.inputMode)) {
+                std::cerr << "Unknown input mode: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--read-ahead") == 0 && i + 1 < argc) {
+            options.readAheadBytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) * 1024 * 1024;
+        } else if (std::strcmp(argv[i], "--frame-cache") == 0 && i + 1 < argc) {
+            options.frameCacheMB = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--frame-cache-scale") == 0 && i + 1 < argc) {
+            options.frameCacheScale = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--frame-cache-420") == 0) {
+            options.frameCacheYuv420 = true;
+        } else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            options.metricsFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+            options.metricsIntervalMs = std::max(10, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            options.traceFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+            exportOptions.output = argv[++i];
+        } else if (std::strcmp(argv[i], "--export-format") == 0 && i + 1 < argc) {
+            if (!ParseRawFormat(argv[++i], exportOptions.format)) {
+                std::cerr << "Unknown export format: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--export-size") == 0 && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &exportOptions.width, &exportOptions.height) != 2) {
+                std::cerr << "Invalid export size: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--export-stride") == 0 && i + 1 < argc) {
+            exportOptions.stride = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--thumbnails") == 0 && i + 1 < argc) {
+            thumbOutput = argv[++i];
+        } else if (std::strcmp(argv[i], "--thumb-count") == 0 && i + 1 < argc) {
+            thumbCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--thumb-width") == 0 && i + 1 < argc) {
+            thumbWidth = std::max(2, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--thumb-cols") == 0 && i + 1 < argc) {
+            thumbCols = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--wall") == 0) {
+            wall = true;
+        } else if (std::strcmp(argv[i], "--shared-pool") == 0) {
+            sharedPool = 1;
+        } else if (std::strcmp(argv[i], "--no-shared-pool") == 0) {
+            sharedPool = 0;
+        } else if (std::strcmp(argv[i], "--task-priority") == 0 && i + 1 < argc) {
+            if (!ParseTaskPriority(argv[++i], options.taskPriority)) {
+                std::cerr << "Unknown task priority: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-') {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (!files.empty()) videoFile = files.front();
+    options.sharedPool = sharedPool < 0 ? wall : sharedPool == 1;
+
+    // 解码线程基准模式：不创建窗口
+    if (benchThreads) {
+        return RunDecodeThreadBench(videoFile, options.decodeThreadType, options.decodeThreads);
+    }
+
+    // 原始帧导出模式：不创建窗口，解码结束后退出
+    if (!exportOptions.output.empty()) {
+        return RunRawExport(videoFile, exportOptions, options);
+    }
+
+    // 缩略图模式：只解码关键帧，写出雪碧图后退出
+    if (!thumbOutput.empty()) {
+        return RunThumbnailExport(videoFile, thumbOutput, thumbCount, thumbWidth, thumbCols, options);
+    }
+
+    // 多路画面：所有文件合成到同一个窗口
+    if (wall) {
+        if (files.empty()) files.push_back(videoFile);
+        VideoWall videoWall(options);
+        if (!videoWall.Initialize(files)) {
+            std::cerr << "Failed to initialize video wall" << std::endl;
+            return 1;
+        }
+        std::cout << "Starting playback of " << videoWall.TileCount() << " streams..." << std::endl;
+        videoWall.Play();
+        videoWall.Run();
+        std::cout << "Player closed successfully!" << std::endl;
+        return 0;
+    }
+
     // 创建播放器实例
-    PlayerRender player;
+    PlayerRender player(options);
+
+    // 加载本地视频文件：解复用器在后台打开，与窗口和 GL 初始化并行
+    std::cout << "Loading video file: " << videoFile << std::endl;
+    player.OpenMediaAsync(videoFile);
 
     // 初始化播放器
     if (!player.Initialize()) {
@@ -18,10 +192,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // 加载本地视频文件
-    std::string videoFile = "../src/wwdc-243.mp4";
-    std::cout << "Loading video file: " << videoFile << std::endl;
-
     if (!player.LoadMedia(videoFile)) {
         std::cerr << "Failed to load video file: " << videoFile << std::endl;
         std::cerr << "Please make sure wwdc-243.mp4 exists in the current directory" << std::endl;
@@ -33,6 +203,11 @@ int main(int argc, char* argv[]) {
     std::cout << "Space     - Play/Pause" << std::endl;
     std::cout << "Left      - Seek backward 10 seconds" << std::endl;
     std::cout << "Right     - Seek forward 10 seconds" << std::endl;
+    std::cout << ", / .     - Step one frame backward / forward (pauses playback)" << std::endl;
+    std::cout << "S         - Print playback statistics" << std::endl;
+    std::cout << "R         - Reset playback statistics" << std::endl;
+    std::cout << "T         - Start/stop trace capture" << std::endl;
+    std::cout << "P         - Toggle PBO texture upload" << std::endl;
     std::cout << "ESC       - Exit" << std::endl;
     std::cout << "================" << std::endl;
     